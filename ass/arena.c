@@ -0,0 +1,95 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Arena
+//
+// Description:
+// Implements the arena declared in arena.h. Every allocation is rounded up
+// to ARENA_ALIGNMENT bytes, so whatever follows it is aligned for any of the
+// types stored in an arena.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGNMENT 8
+
+static void newBlock(struct Arena *arena, size_t size);
+
+// Creates an empty arena
+// No memory is taken until the first allocation
+void arenaInit(struct Arena *arena) {
+    arena->blocks = NULL;
+    arena->next = NULL;
+    arena->remaining = 0;
+}
+
+// Frees every block of the arena, and everything allocated from it
+void arenaFree(struct Arena *arena) {
+    struct ArenaBlock *block = arena->blocks;
+    while (block != NULL) {
+        struct ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arenaInit(arena);
+}
+
+// Frees everything allocated from the arena, but keeps its oldest block, so
+// refilling it takes no new memory
+void arenaReset(struct Arena *arena) {
+    if (arena->blocks == NULL) {
+        return;
+    }
+
+    struct ArenaBlock *first = arena->blocks;
+    while (first->next != NULL) {
+        struct ArenaBlock *next = first->next;
+        free(first);
+        first = next;
+    }
+
+    arena->blocks = first;
+    arena->next = first->bytes;
+    arena->remaining = first->size;
+}
+
+// Returns size bytes of the arena, not cleared
+void *arenaAlloc(struct Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (size > arena->remaining) {
+        newBlock(arena, size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE);
+    }
+
+    void *ptr = arena->next;
+    arena->next += size;
+    arena->remaining -= size;
+
+    return ptr;
+}
+
+// Returns a copy of the first len characters of str, terminated by '\0'
+char *arenaStrndup(struct Arena *arena, const char *str, size_t len) {
+    char *copy = arenaAlloc(arena, len + 1);
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    return copy;
+}
+
+// Starts a new block of at least size bytes, which becomes the current one
+// The rest of the old block is left unused
+static void newBlock(struct Arena *arena, size_t size) {
+    struct ArenaBlock *block = malloc(sizeof(struct ArenaBlock) + size);
+    if (block == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    block->next = arena->blocks;
+    block->size = size;
+    arena->blocks = block;
+    arena->next = block->bytes;
+    arena->remaining = size;
+}
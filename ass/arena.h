@@ -0,0 +1,41 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Arena
+//
+// Description:
+// A region allocator for many small objects that all live until the same
+// moment. Each allocation takes the next bytes of the current block, so it
+// costs a pointer bump, carries no header, and is never freed on its own.
+// When a block is full a new one is started; a request larger than a block
+// gets a block of its own. Everything allocated from an arena is released at
+// once by arenaFree, or by arenaReset, which keeps the first block for reuse,
+// so an arena can also serve as scratch memory that is cleared after every
+// page. An arena is used by one thread at a time.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    char bytes[];
+};
+
+struct Arena {
+    // The blocks, the current one first
+    struct ArenaBlock *blocks;
+    char *next;
+    size_t remaining;
+};
+
+void arenaInit(struct Arena *arena);
+void arenaFree(struct Arena *arena);
+void arenaReset(struct Arena *arena);
+
+void *arenaAlloc(struct Arena *arena, size_t size);
+char *arenaStrndup(struct Arena *arena, const char *str, size_t len);
+
+#endif
@@ -0,0 +1,295 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Synthetic Collection Generator
+//
+// Description:
+// This program writes a synthetic collection of NUMPAGES pages to DIRECTORY,
+// in the same form as the test collections: "collection.txt" and one
+// url*.txt file per page, with its links in Section-1 and its words in
+// Section-2. It also writes "queries.txt", one query per line, for
+// searchPagerank --serve. The collection is built to look like a crawl:
+//     - the outdegrees follow a power law, and some pages have no links
+//     - the targets of the links are drawn from a Zipf distribution over the
+//       pages, so a few pages get most of the links, with some self links
+//       and repeated links that pagerank must ignore
+//     - the words are drawn from a Zipf distribution over the vocabulary,
+//       some capitalised or ending in punctuation, which invertedIndex must
+//       normalise
+//     - the queries are one to four words of the same distribution
+// The same arguments always give the same collection.
+//
+// Usage: ./genCollection [--seed N] [--words N] [--vocabulary N]
+//            [--max-links N] [--queries N] NUMPAGES DIRECTORY
+//     --seed N          seeds the random numbers (default 1)
+//     --words N         the mean number of words of a page (default 50)
+//     --vocabulary N    the number of distinct words (default 50000)
+//     --max-links N     the largest outdegree of a page (default 1000)
+//     --queries N       the number of queries written (default 1000)
+// NUMPAGES may be written as 1e6.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#define URLS_PER_LINE 8
+#define DANGLING_FRACTION 0.1
+#define LINK_EXPONENT 2.1
+#define TARGET_SKEW 1.0
+#define WORD_SKEW 1.0
+#define MIN_WORD_LENGTH 3
+#define MAX_WORD_LENGTH 10
+#define MAX_QUERY_TERMS 4
+
+// Command-line arguments
+struct Arguments {
+    uint64_t seed;
+    int meanWords;
+    int vocabulary;
+    int maxLinks;
+    int numQueries;
+    int numPages;
+    char *directory;
+};
+
+// The state of a xorshift64* generator
+struct Random {
+    uint64_t state;
+};
+
+// Function Prototypes
+void parseArguments(int argc, char **argv, struct Arguments *args);
+void printUsage(char *program);
+void writeCollection(struct Arguments *args);
+void writePage(struct Arguments *args, struct Random *random, int page,
+    int *popular, char *filename);
+void writeQueries(struct Arguments *args, struct Random *random);
+void writeWord(FILE *file, int rank, int capital);
+FILE *openFile(struct Arguments *args, const char *name, char *filename);
+int zipfRank(struct Random *random, int n, double skew);
+uint64_t nextRandom(struct Random *random);
+double uniform(struct Random *random);
+
+int main(int argc, char **argv) {
+    struct Arguments args;
+    parseArguments(argc, argv, &args);
+
+    mkdir(args.directory, 0777);
+
+    writeCollection(&args);
+
+    struct Random random = {args.seed * 2 + 2};
+    writeQueries(&args, &random);
+
+    return 0;
+}
+
+// Reads the options, the number of pages and the directory
+// Exits with the usage message if they are not valid
+void parseArguments(int argc, char **argv, struct Arguments *args) {
+    args->seed = 1;
+    args->meanWords = 50;
+    args->vocabulary = 50000;
+    args->maxLinks = 1000;
+    args->numQueries = 1000;
+
+    int i = 1;
+    while (i + 1 < argc && strncmp(argv[i], "--", 2) == 0) {
+        int value = atoi(argv[i + 1]);
+        if (strcmp(argv[i], "--seed") == 0) {
+            args->seed = value;
+        } else if (strcmp(argv[i], "--words") == 0) {
+            args->meanWords = value;
+        } else if (strcmp(argv[i], "--vocabulary") == 0) {
+            args->vocabulary = value;
+        } else if (strcmp(argv[i], "--max-links") == 0) {
+            args->maxLinks = value;
+        } else if (strcmp(argv[i], "--queries") == 0) {
+            args->numQueries = value;
+        } else {
+            printUsage(argv[0]);
+        }
+        i += 2;
+    }
+
+    if (argc - i != 2) {
+        printUsage(argv[0]);
+    }
+
+    args->numPages = (int)atof(argv[i]);
+    args->directory = argv[i + 1];
+    if (args->numPages < 1 || args->meanWords < 0 || args->vocabulary < 1 ||
+        args->maxLinks < 0 || args->numQueries < 0) {
+        printUsage(argv[0]);
+    }
+}
+
+// Prints the usage message and exits
+void printUsage(char *program) {
+    fprintf(stderr, "Usage: %s [--seed N] [--words N] [--vocabulary N]\n"
+        "           [--max-links N] [--queries N] NUMPAGES DIRECTORY\n",
+        program);
+    exit(EXIT_FAILURE);
+}
+
+// Writes collection.txt and every page
+void writeCollection(struct Arguments *args) {
+    char *filename = malloc(strlen(args->directory) + 32);
+    int *popular = malloc((args->numPages + 1) * sizeof(int));
+    if (filename == NULL || popular == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    FILE *file = openFile(args, "collection.txt", filename);
+    for (int i = 0; i < args->numPages; i++) {
+        fprintf(file, "url%d%c", i,
+            (i + 1) % URLS_PER_LINE == 0 ? '\n' : ' ');
+    }
+    fprintf(file, "\n");
+    fclose(file);
+
+    // The most linked pages are spread over the collection, so they are
+    // not simply the first pages
+    struct Random random = {args->seed * 2 + 1};
+    for (int i = 0; i < args->numPages; i++) {
+        popular[i] = i;
+    }
+    for (int i = args->numPages - 1; i > 0; i--) {
+        int j = nextRandom(&random) % (i + 1);
+        int temp = popular[i];
+        popular[i] = popular[j];
+        popular[j] = temp;
+    }
+
+    for (int i = 0; i < args->numPages; i++) {
+        writePage(args, &random, i, popular, filename);
+    }
+
+    free(popular);
+    free(filename);
+}
+
+// Writes the links and words of one page
+// popular[r] is the page with the r-th most links to it
+void writePage(
+    struct Arguments *args, struct Random *random, int page, int *popular,
+    char *filename
+) {
+    char name[32];
+    sprintf(name, "url%d.txt", page);
+    FILE *file = openFile(args, name, filename);
+
+    // The outdegree follows a power law, from 1 up
+    int numLinks = 0;
+    if (uniform(random) >= DANGLING_FRACTION) {
+        double x = pow(1 - uniform(random), -1 / (LINK_EXPONENT - 1));
+        numLinks = x < args->maxLinks ? (int)x : args->maxLinks;
+    }
+
+    fprintf(file, "#start Section-1\n\n");
+    for (int i = 0; i < numLinks; i++) {
+        int target = popular[zipfRank(random, args->numPages, TARGET_SKEW)];
+        fprintf(file, "url%d%c", target,
+            (i + 1) % URLS_PER_LINE == 0 ? '\n' : ' ');
+    }
+    fprintf(file, "\n\n#end Section-1\n\n#start Section-2\n\n");
+
+    int numWords = args->meanWords > 0 ?
+        nextRandom(random) % (2 * args->meanWords + 1) : 0;
+    for (int i = 0; i < numWords; i++) {
+        // Some words need normalising
+        uint64_t style = nextRandom(random) % 100;
+        writeWord(file, zipfRank(random, args->vocabulary, WORD_SKEW),
+            style >= 90);
+        if (style < 5) {
+            fputc(".,:;?*"[style], file);
+        }
+        fputc((i + 1) % 12 == 0 ? '\n' : ' ', file);
+    }
+    fprintf(file, "\n\n#end Section-2\n");
+
+    fclose(file);
+}
+
+// Writes queries.txt, each line a query of one to four words
+void writeQueries(struct Arguments *args, struct Random *random) {
+    char *filename = malloc(strlen(args->directory) + 32);
+    if (filename == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    FILE *file = openFile(args, "queries.txt", filename);
+    for (int q = 0; q < args->numQueries; q++) {
+        int numTerms = 1 + nextRandom(random) % MAX_QUERY_TERMS;
+        for (int i = 0; i < numTerms; i++) {
+            if (i > 0) {
+                fputc(' ', file);
+            }
+            writeWord(file, zipfRank(random, args->vocabulary, WORD_SKEW),
+                0);
+        }
+        fputc('\n', file);
+    }
+
+    fclose(file);
+    free(filename);
+}
+
+// Writes the word with the given rank in the vocabulary, starting with a
+// capital letter if capital is set
+// The letters are drawn from a generator seeded by the rank, so a rank
+// always gives the same word
+void writeWord(FILE *file, int rank, int capital) {
+    struct Random letters = {(uint64_t)rank * 2654435761u + 1};
+    int length = MIN_WORD_LENGTH +
+        nextRandom(&letters) % (MAX_WORD_LENGTH - MIN_WORD_LENGTH + 1);
+    for (int i = 0; i < length; i++) {
+        char base = capital && i == 0 ? 'A' : 'a';
+        fputc(base + nextRandom(&letters) % 26, file);
+    }
+}
+
+// Opens a file of the directory for writing
+// filename must have room for the directory and the name
+FILE *openFile(struct Arguments *args, const char *name, char *filename) {
+    sprintf(filename, "%s/%s", args->directory, name);
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    return file;
+}
+
+// Returns a rank from 0 to n - 1, rank r being drawn with a probability of
+// about 1 / (r + 1)^skew
+// Inverts the distribution function of the continuous power law on [1, n + 1)
+int zipfRank(struct Random *random, int n, double skew) {
+    double u = uniform(random);
+    double x;
+    if (skew == 1) {
+        x = exp(u * log(n + 1.0));
+    } else {
+        x = pow(u * (pow(n + 1.0, 1 - skew) - 1) + 1, 1 / (1 - skew));
+    }
+
+    int rank = (int)x - 1;
+    return rank < 0 ? 0 : rank >= n ? n - 1 : rank;
+}
+
+// Returns the next number of a xorshift64* generator
+uint64_t nextRandom(struct Random *random) {
+    random->state ^= random->state >> 12;
+    random->state ^= random->state << 25;
+    random->state ^= random->state >> 27;
+    return random->state * 2685821657736338717ull;
+}
+
+// Returns a number drawn uniformly from [0, 1)
+double uniform(struct Random *random) {
+    return (nextRandom(random) >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,93 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Collection
+//
+// Description:
+// Implements the collection declared in collection.h. collection.txt is
+// split into URLs by the same page scanner as the pages, so a URL may be of
+// any length. Any problem reading the collection ends the program.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "collection.h"
+
+#define COLLECTION_FILE_NAME "collection.txt"
+
+// Reads the URLs of the collection
+// If packFilename is NULL, reads them from collection.txt, and the pages will
+// be read from their url*.txt files. Otherwise maps the pack file and reads
+// everything from it.
+struct Collection *collectionOpen(const char *packFilename) {
+    struct Collection *collection = malloc(sizeof(struct Collection));
+    if (collection == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    collection->urls = internTableNew();
+    collection->pack = NULL;
+
+    if (packFilename != NULL) {
+        collection->pack = packFileOpen(packFilename);
+        if (collection->pack == NULL) {
+            fprintf(stderr, "Error opening %s\n", packFilename);
+            exit(EXIT_FAILURE);
+        }
+
+        for (int i = 0; i < collection->pack->numPages; i++) {
+            internTableInsert(collection->urls,
+                packFileUrl(collection->pack, i));
+        }
+
+        return collection;
+    }
+
+    struct PageScanner scanner;
+    pageScannerInit(&scanner);
+    if (!pageScannerOpen(&scanner, COLLECTION_FILE_NAME)) {
+        fprintf(stderr, "Error opening %s\n", COLLECTION_FILE_NAME);
+        exit(EXIT_FAILURE);
+    }
+
+    struct StringView url;
+    while (pageScannerNextToken(&scanner, &url)) {
+        internTableInsertN(collection->urls, url.chars, url.length);
+    }
+
+    pageScannerFree(&scanner);
+
+    return collection;
+}
+
+// Frees the URL table, and unmaps the pack file
+void collectionFree(struct Collection *collection) {
+    internTableFree(collection->urls);
+    packFileClose(collection->pack);
+    free(collection);
+}
+
+// Opens the text of a page for scanning
+// Several threads may open pages at the same time, each with its own scanner
+void collectionOpenPage(
+    struct Collection *collection, int page, struct PageScanner *scanner
+) {
+    if (collection->pack != NULL) {
+        size_t size;
+        const char *text = packFilePage(collection->pack, page, &size);
+        pageScannerOpenText(scanner, text, size);
+        return;
+    }
+
+    // The file name is made in the scratch memory of the scanner, so
+    // opening a page allocates nothing once the first page is open
+    const char *url = internTableString(collection->urls, page);
+    char *filename = arenaAlloc(&scanner->scratch, strlen(url) + 5);
+    sprintf(filename, "%s.txt", url);
+    if (!pageScannerOpen(scanner, filename)) {
+        fprintf(stderr, "Error opening %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    arenaReset(&scanner->scratch);
+}
@@ -0,0 +1,30 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Collection
+//
+// Description:
+// The URLs of a collection and the text of its pages, read either from
+// collection.txt and one url*.txt file per page, or from a single pack file
+// (see packFile.h). Every URL is given an ID in the URL table in the order of
+// collection.txt, and a URL listed twice only gets one ID, so both sources
+// give the same IDs.
+
+#ifndef COLLECTION_H
+#define COLLECTION_H
+
+#include "internTable.h"
+#include "packFile.h"
+#include "pageScanner.h"
+
+struct Collection {
+    struct InternTable *urls;
+
+    // The mapped pack file, or NULL if the pages are url*.txt files
+    struct PackFile *pack;
+};
+
+struct Collection *collectionOpen(const char *packFilename);
+void collectionFree(struct Collection *collection);
+void collectionOpenPage(struct Collection *collection, int page,
+    struct PageScanner *scanner);
+
+#endif
@@ -0,0 +1,151 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Graph Structure
+//
+// Description:
+// Builds the compressed sparse graph declared in graph.h. The edge list is
+// converted with a counting sort on the destination page, which keeps the
+// in-links of every page in the order in which they were read.
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "graph.h"
+
+#define INITIAL_EDGE_CAPACITY 64
+
+static void *allocOrExit(size_t size);
+
+// Initializes an empty edge list
+void edgeListInit(struct EdgeList *edges) {
+    edges->numEdges = 0;
+    edges->capacity = 0;
+    edges->src = NULL;
+    edges->dst = NULL;
+}
+
+// Appends the link src -> dst to the edge list
+// The arrays are doubled whenever they are full
+void edgeListAppend(struct EdgeList *edges, int src, int dst) {
+    if (edges->numEdges == edges->capacity) {
+        int capacity = edges->capacity == 0
+            ? INITIAL_EDGE_CAPACITY : edges->capacity * 2;
+
+        int *newSrc = realloc(edges->src, capacity * sizeof(int));
+        int *newDst = realloc(edges->dst, capacity * sizeof(int));
+        if (newSrc == NULL || newDst == NULL) {
+            fprintf(stderr, "error: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+
+        edges->src = newSrc;
+        edges->dst = newDst;
+        edges->capacity = capacity;
+    }
+
+    edges->src[edges->numEdges] = src;
+    edges->dst[edges->numEdges] = dst;
+    edges->numEdges++;
+}
+
+// Frees the memory allocated to the edge list
+void edgeListFree(struct EdgeList *edges) {
+    free(edges->src);
+    free(edges->dst);
+    edgeListInit(edges);
+}
+
+// Packs the edge list into a graph with contiguous in-link arrays
+// The edge list must not contain self links or duplicate links
+struct Graph *graphBuild(int numPages, struct EdgeList *edges) {
+    struct Graph *graph = allocOrExit(sizeof(struct Graph));
+    graph->numPages = numPages;
+    graph->numEdges = edges->numEdges;
+    graph->outdegree = allocOrExit((numPages + 1) * sizeof(int));
+    graph->inOffsets = allocOrExit((numPages + 1) * sizeof(int));
+    graph->inLinks = allocOrExit((edges->numEdges + 1) * sizeof(int));
+    graph->outOffsets = NULL;
+    graph->outLinks = NULL;
+
+    for (int i = 0; i <= numPages; i++) {
+        graph->outdegree[i] = 0;
+        graph->inOffsets[i] = 0;
+    }
+
+    // Counts the outdegree and the indegree of every page
+    for (int e = 0; e < edges->numEdges; e++) {
+        graph->outdegree[edges->src[e]]++;
+        graph->inOffsets[edges->dst[e] + 1]++;
+    }
+
+    // Turns the indegrees into the starting offset of each page
+    for (int i = 0; i < numPages; i++) {
+        graph->inOffsets[i + 1] += graph->inOffsets[i];
+    }
+
+    // Places every link after the links already placed for its destination
+    int *next = allocOrExit((numPages + 1) * sizeof(int));
+    for (int i = 0; i < numPages; i++) {
+        next[i] = graph->inOffsets[i];
+    }
+
+    for (int e = 0; e < edges->numEdges; e++) {
+        graph->inLinks[next[edges->dst[e]]++] = edges->src[e];
+    }
+
+    free(next);
+
+    return graph;
+}
+
+// Builds the out-link arrays from the in-link arrays
+// The out-links of every page end up in ascending order
+void graphBuildOutLinks(struct Graph *graph) {
+    if (graph->outOffsets != NULL) {
+        return;
+    }
+
+    int numPages = graph->numPages;
+    graph->outOffsets = allocOrExit((numPages + 1) * sizeof(int));
+    graph->outLinks = allocOrExit((graph->numEdges + 1) * sizeof(int));
+
+    graph->outOffsets[0] = 0;
+    for (int j = 0; j < numPages; j++) {
+        graph->outOffsets[j + 1] = graph->outOffsets[j] + graph->outdegree[j];
+    }
+
+    int *next = allocOrExit((numPages + 1) * sizeof(int));
+    for (int j = 0; j < numPages; j++) {
+        next[j] = graph->outOffsets[j];
+    }
+
+    for (int i = 0; i < numPages; i++) {
+        for (int k = graph->inOffsets[i]; k < graph->inOffsets[i + 1]; k++) {
+            graph->outLinks[next[graph->inLinks[k]]++] = i;
+        }
+    }
+
+    free(next);
+}
+
+// Frees the memory allocated to the graph
+void graphFree(struct Graph *graph) {
+    if (graph != NULL) {
+        free(graph->outdegree);
+        free(graph->inOffsets);
+        free(graph->inLinks);
+        free(graph->outOffsets);
+        free(graph->outLinks);
+        free(graph);
+    }
+}
+
+// Allocates memory and exits if there is none left
+static void *allocOrExit(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
@@ -0,0 +1,50 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Graph Structure
+//
+// Description:
+// A compressed sparse graph of the web pages in a collection. Links are
+// collected into an edge list while the pages are read, then packed once into
+// compressed sparse column (CSC) form, so that the in-links of every page are
+// stored contiguously. Page j linking to page i is stored as the in-link j of
+// page i. Each PageRank iteration can then visit every link exactly once.
+// The out-links of every page (CSR form) are only built when asked for, since
+// only the push-based solver needs them.
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+// Links collected while the pages are being read
+struct EdgeList {
+    int numEdges;
+    int capacity;
+    int *src;
+    int *dst;
+};
+
+struct Graph {
+    int numPages;
+    int numEdges;
+
+    // Number of distinct outgoing links of each page
+    int *outdegree;
+
+    // The in-links of page i are inLinks[inOffsets[i]] to
+    // inLinks[inOffsets[i + 1] - 1]
+    int *inOffsets;
+    int *inLinks;
+
+    // The out-links of page j are outLinks[outOffsets[j]] to
+    // outLinks[outOffsets[j + 1] - 1], NULL until graphBuildOutLinks is called
+    int *outOffsets;
+    int *outLinks;
+};
+
+void edgeListInit(struct EdgeList *edges);
+void edgeListAppend(struct EdgeList *edges, int src, int dst);
+void edgeListFree(struct EdgeList *edges);
+
+struct Graph *graphBuild(int numPages, struct EdgeList *edges);
+void graphBuildOutLinks(struct Graph *graph);
+void graphFree(struct Graph *graph);
+
+#endif
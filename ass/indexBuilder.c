@@ -0,0 +1,674 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Inverted Index Builder
+//
+// Description:
+// Implements the index builder declared in indexBuilder.h. Words are
+// normalised before they are added: punctuation is removed from their end and
+// they are converted to lowercase. When the index is written, the URLs are
+// numbered in alphabetical order, and every posting list is sorted by these
+// numbers. When the PageRank values are known, the binary index numbers the
+// pages again in impact order, so that searchPagerank meets the best pages
+// of a posting list first.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "indexBuilder.h"
+#include "indexFile.h"
+#include "outputWriter.h"
+#include "rankList.h"
+#include "stats.h"
+
+#define FIRST_CHUNK_PAGES 4
+#define MAX_CHUNK_PAGES 1024
+
+// A URL or word together with its ID in its table, for sorting
+struct SortedString {
+    const char *string;
+    int id;
+};
+
+// The words and URLs of the text index, in the order they are written
+struct IndexLines {
+    struct IndexBuilder *builder;
+    struct SortedString *words;
+    struct SortedString *sortedUrls;
+};
+
+// A page of the binary index, for sorting into impact order
+struct RankedPage {
+    const char *url;
+    double pagerank;
+    int outdegree;
+    int page;
+};
+
+static void normalizeWord(char *word);
+static struct Postings *newPostings(struct IndexBuilder *builder, int id);
+static void insertFileName(struct IndexBuilder *builder,
+    struct Postings *postings, int page);
+static void joinPostings(struct IndexBuilder *builder);
+static struct SortedString *sortStrings(struct InternTable *table);
+static void sortPostings(struct IndexBuilder *builder, int *newIds);
+static void printInvertedIndex(FILE *file, struct IndexBuilder *builder,
+    struct SortedString *words, struct SortedString *sortedUrls,
+    int numThreads);
+static void writeIndexLine(struct OutputWriter *writer, int i,
+    void *context);
+static void writeBinaryIndex(char *filename, struct InternTable *urls,
+    struct IndexBuilder *builder, struct SortedString *words,
+    struct SortedString *sortedUrls, int *newIds, int *outdegrees,
+    double *pageranks);
+static void readPageranks(const char *filename, struct InternTable *urls,
+    int *newIds, struct IndexData *data);
+static void orderByRank(struct IndexData *data);
+static int compareSortedStrings(const void *a, const void *b);
+static int compareRankedPages(const void *a, const void *b);
+static int compareIds(const void *a, const void *b);
+static void siftDownShards(int *heap, int size, int i,
+    struct SortedString **words, const int *next);
+static void siftUpShards(int *heap, int i, struct SortedString **words,
+    const int *next);
+static int shardBefore(int a, int b, struct SortedString **words,
+    const int *next);
+
+// Creates an inverted index with no words
+struct IndexBuilder *indexBuilderNew(void) {
+    struct IndexBuilder *builder = malloc(sizeof(struct IndexBuilder));
+    if (builder == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    builder->words = internTableNew();
+    builder->postings = NULL;
+    builder->capacity = 0;
+    arenaInit(&builder->arena);
+    builder->word = NULL;
+    builder->wordCapacity = 0;
+
+    return builder;
+}
+
+// Frees the memory allocated to the word table
+// and the posting list of every word, all at once
+void indexBuilderFree(struct IndexBuilder *builder) {
+    arenaFree(&builder->arena);
+    free(builder->postings);
+    free(builder->word);
+    internTableFree(builder->words);
+    free(builder);
+}
+
+// Normalises the word and adds it to the index, unless nothing is left of it
+// Looks the word up in the word table, giving it an ID if it is new
+// Also inserts the URL in which the word appears to the word's posting list
+// The word is copied into the builder's own buffer first, so the text it
+// comes from is not changed
+void indexBuilderAddWord(
+    struct IndexBuilder *builder, const char *chars, size_t length, int page
+) {
+    if (length + 1 > builder->wordCapacity) {
+        builder->wordCapacity = length + 1;
+        builder->word = realloc(builder->word, builder->wordCapacity);
+        if (builder->word == NULL) {
+            fprintf(stderr, "error: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    char *word = builder->word;
+    memcpy(word, chars, length);
+    word[length] = '\0';
+
+    normalizeWord(word);
+    if (word[0] == '\0') {
+        return;
+    }
+
+    int numWords = internTableSize(builder->words);
+    int id = internTableInsert(builder->words, word);
+
+    // A new word starts with an empty posting list
+    if (id == numWords) {
+        newPostings(builder, id);
+    }
+
+    insertFileName(builder, &(builder->postings[id]), page);
+}
+
+// Creates the empty posting list of the new word with the given ID
+static struct Postings *newPostings(struct IndexBuilder *builder, int id) {
+    if (id == builder->capacity) {
+        builder->capacity = builder->capacity == 0 ? 64 :
+            builder->capacity * 2;
+        builder->postings = realloc(builder->postings,
+            builder->capacity * sizeof(struct Postings));
+        if (builder->postings == NULL) {
+            fprintf(stderr, "error: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    builder->postings[id].first = NULL;
+    builder->postings[id].last = NULL;
+    builder->postings[id].pages = NULL;
+    builder->postings[id].numPages = 0;
+
+    return &builder->postings[id];
+}
+
+// Merges builders that were given disjoint ranges of pages into one
+// The shards must be in ascending order of their pages, so that joining the
+// posting lists of a word in shard order keeps them in page order
+// The words are merged in alphabetical order, by repeatedly taking the
+// smallest next word of the shards from a heap of the shards, so the merged
+// word IDs are already in alphabetical order
+struct IndexBuilder *indexBuilderMerge(
+    struct IndexBuilder **shards, int numShards
+) {
+    struct IndexBuilder *merged = indexBuilderNew();
+
+    struct SortedString **words = malloc(numShards * 
+        sizeof(struct SortedString *));
+    int *next = calloc(numShards, sizeof(int));
+    int *heap = malloc(numShards * sizeof(int));
+    int *group = malloc(numShards * sizeof(int));
+    if (words == NULL || next == NULL || heap == NULL || group == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // The shards that have words left, ordered by their next word, then by
+    // shard
+    int heapSize = 0;
+    for (int s = 0; s < numShards; s++) {
+        words[s] = sortStrings(shards[s]->words);
+        joinPostings(shards[s]);
+        if (internTableSize(shards[s]->words) > 0) {
+            heap[heapSize++] = s;
+        }
+    }
+    for (int i = heapSize / 2 - 1; i >= 0; i--) {
+        siftDownShards(heap, heapSize, i, words, next);
+    }
+
+    while (heapSize > 0) {
+        // Takes every shard whose next word is the smallest, in shard order,
+        // and counts the pages of the word in them
+        const char *word = words[heap[0]][next[heap[0]]].string;
+        int numGroup = 0;
+        int numPages = 0;
+        while (heapSize > 0 &&
+               strcmp(words[heap[0]][next[heap[0]]].string, word) == 0) {
+            int s = heap[0];
+            group[numGroup++] = s;
+            numPages += shards[s]->postings[words[s][next[s]].id].numPages;
+
+            heap[0] = heap[--heapSize];
+            siftDownShards(heap, heapSize, 0, words, next);
+        }
+
+        // Joins the posting lists, in shard order
+        int id = internTableInsert(merged->words, word);
+        struct Postings *postings = newPostings(merged, id);
+        postings->pages = arenaAlloc(&merged->arena, numPages * sizeof(int));
+
+        for (int g = 0; g < numGroup; g++) {
+            int s = group[g];
+            struct Postings *shard = 
+                &shards[s]->postings[words[s][next[s]].id];
+            memcpy(postings->pages + postings->numPages, shard->pages, 
+                shard->numPages * sizeof(int));
+            postings->numPages += shard->numPages;
+
+            next[s]++;
+            if (next[s] < internTableSize(shards[s]->words)) {
+                heap[heapSize] = s;
+                siftUpShards(heap, heapSize++, words, next);
+            }
+        }
+    }
+
+    for (int s = 0; s < numShards; s++) {
+        free(words[s]);
+    }
+    free(words);
+    free(next);
+    free(heap);
+    free(group);
+
+    return merged;
+}
+
+// Writes the index to "invertedIndex.txt" and "invertedIndex.bin"
+// outdegrees and pageranks, indexed by the ID of the URL in urls, are copied
+// to the binary index. If they are NULL, they are read from
+// "pagerankList.txt" instead, if pagerank has been run.
+// The lines of the text index are formatted by numThreads threads.
+void indexBuilderWrite(
+    struct IndexBuilder *builder, struct InternTable *urls,
+    int *outdegrees, double *pageranks, int numThreads
+) {
+    // Opens "invertedIndex.txt" in write mode
+    // This is the output file for the inverted index
+    char *filename = "invertedIndex.txt";
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    // Sorts the words, and numbers the URLs in alphabetical order
+    // Every posting list is then sorted by these numbers
+    statsPhase("sort");
+    joinPostings(builder);
+    struct SortedString *words = sortStrings(builder->words);
+    struct SortedString *sortedUrls = sortStrings(urls);
+    int *newIds = malloc((internTableSize(urls) + 1) * sizeof(int));
+    if (newIds == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < internTableSize(urls); i++) {
+        newIds[sortedUrls[i].id] = i;
+    }
+
+    sortPostings(builder, newIds);
+    statsPhase("write");
+
+    // Prints the inverted indices to the output file
+    // Prints in alphabetical order of the words
+    printInvertedIndex(file, builder, words, sortedUrls, numThreads);
+    fclose(file);
+
+    // Writes the same index in binary form for searchPagerank
+    writeBinaryIndex(INDEX_FILE_NAME, urls, builder, words, sortedUrls,
+        newIds, outdegrees, pageranks);
+
+    free(words);
+    free(sortedUrls);
+    free(newIds);
+}
+
+// It normalises the word by
+// removing symbols and punctuations from the end and
+// converts the word to lowercase.
+static void normalizeWord(char *word) {
+    int len = strlen(word);
+
+    // Checks particularly for these 6 punctuations in the end of the word
+    // Removes it if it exists
+    // Symbols at start or in the middle of the word are left as it is
+    while (len > 0 && (word[len - 1] == '.' || word[len - 1] == ',' ||
+                       word[len - 1] == ':' || word[len - 1] == ';' ||
+                       word[len - 1] == '?' || word[len - 1] == '*')) {
+        len--;
+    }
+
+    word[len] = '\0';
+
+    // Converts the word to lower-case
+    for (int i = 0; i < len; i++) {
+        word[i] = tolower(word[i]);
+    }
+}
+
+// Appends the URL's ID to the posting list of a word
+// The pages are read one after another, so the URL is already in the list
+// exactly when it is the last one there
+static void insertFileName(
+    struct IndexBuilder *builder, struct Postings *postings, int page
+) {
+    struct PostingChunk *last = postings->last;
+    if (last != NULL && last->pages[last->numPages - 1] == page) {
+        return;
+    }
+
+    // Starts a new chunk when the last one is full
+    if (last == NULL || last->numPages == last->capacity) {
+        int capacity = last == NULL ? FIRST_CHUNK_PAGES :
+            last->capacity < MAX_CHUNK_PAGES ? last->capacity * 2 :
+            MAX_CHUNK_PAGES;
+        struct PostingChunk *chunk = arenaAlloc(&builder->arena,
+            sizeof(struct PostingChunk) + capacity * sizeof(int));
+        chunk->next = NULL;
+        chunk->numPages = 0;
+        chunk->capacity = capacity;
+
+        if (last == NULL) {
+            postings->first = chunk;
+        } else {
+            last->next = chunk;
+        }
+        postings->last = chunk;
+        last = chunk;
+    }
+
+    last->pages[last->numPages++] = page;
+    postings->numPages++;
+}
+
+// Joins the chunks of every posting list into one array
+// A list of one chunk is used where it is, so most lists are not copied
+static void joinPostings(struct IndexBuilder *builder) {
+    for (int i = 0; i < internTableSize(builder->words); i++) {
+        struct Postings *postings = &builder->postings[i];
+        if (postings->pages != NULL || postings->first == NULL) {
+            continue;
+        }
+
+        if (postings->first == postings->last) {
+            postings->pages = postings->first->pages;
+            continue;
+        }
+
+        postings->pages = arenaAlloc(&builder->arena,
+            postings->numPages * sizeof(int));
+        int numPages = 0;
+        for (struct PostingChunk *chunk = postings->first; chunk != NULL;
+             chunk = chunk->next) {
+            memcpy(postings->pages + numPages, chunk->pages,
+                chunk->numPages * sizeof(int));
+            numPages += chunk->numPages;
+        }
+    }
+}
+
+// Returns the strings of the table with their IDs, in alphabetical order
+// The table must not change while the result is in use
+static struct SortedString *sortStrings(struct InternTable *table) {
+    int size = internTableSize(table);
+    struct SortedString *sorted = malloc((size + 1) *
+        sizeof(struct SortedString));
+    if (sorted == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < size; i++) {
+        sorted[i].string = internTableString(table, i);
+        sorted[i].id = i;
+    }
+
+    qsort(sorted, size, sizeof(struct SortedString), compareSortedStrings);
+
+    return sorted;
+}
+
+// Replaces the URL IDs in every posting list by their alphabetical
+// positions, newIds, and sorts each list into that order
+static void sortPostings(struct IndexBuilder *builder, int *newIds) {
+    for (int i = 0; i < internTableSize(builder->words); i++) {
+        struct Postings *postings = &builder->postings[i];
+        for (int j = 0; j < postings->numPages; j++) {
+            postings->pages[j] = newIds[postings->pages[j]];
+        }
+
+        qsort(postings->pages, postings->numPages, sizeof(int), compareIds);
+    }
+}
+
+// Prints the inverted index to the output file, "invertedIndex.txt"
+// Prints the words in the alphabetical order given by words
+static void printInvertedIndex(
+    FILE *file, struct IndexBuilder *builder, struct SortedString *words,
+    struct SortedString *sortedUrls, int numThreads
+) {
+    struct IndexLines lines = {builder, words, sortedUrls};
+    outputWriteParallel(file, internTableSize(builder->words), numThreads,
+        writeIndexLine, &lines);
+}
+
+// Writes the line of the i-th word: the word, then all the URLs associated
+// to it
+static void writeIndexLine(
+    struct OutputWriter *writer, int i, void *context
+) {
+    struct IndexLines *lines = context;
+    outputWriteString(writer, lines->words[i].string);
+
+    struct Postings *postings = &lines->builder->postings[lines->words[i].id];
+    for (int j = 0; j < postings->numPages; j++) {
+        outputWriteChar(writer, ' ');
+        outputWriteString(writer, lines->sortedUrls[postings->pages[j]].string);
+    }
+
+    outputWriteChar(writer, '\n');
+}
+
+// Writes the inverted index to the binary index file (see indexFile.h)
+// Pages are numbered in alphabetical order of URL, which is the order of
+// every sorted posting list, unless they have PageRank values
+static void writeBinaryIndex(
+    char *filename, struct InternTable *urls, struct IndexBuilder *builder,
+    struct SortedString *words, struct SortedString *sortedUrls, int *newIds,
+    int *outdegrees, double *pageranks
+) {
+    struct IndexData data;
+    data.numPages = internTableSize(urls);
+    data.numTerms = internTableSize(builder->words);
+
+    data.urls = malloc((data.numPages + 1) * sizeof(char *));
+    data.outdegrees = calloc(data.numPages + 1, sizeof(int));
+    data.pageranks = calloc(data.numPages + 1, sizeof(double));
+    data.terms = malloc((data.numTerms + 1) * sizeof(char *));
+    data.postingOffsets = malloc((data.numTerms + 1) * sizeof(uint64_t));
+    if (data.urls == NULL || data.outdegrees == NULL ||
+        data.pageranks == NULL || data.terms == NULL ||
+        data.postingOffsets == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < data.numPages; i++) {
+        data.urls[i] = sortedUrls[i].string;
+    }
+
+    // Lays the posting lists out one after another, in alphabetical order
+    // of the words
+    data.postingOffsets[0] = 0;
+    for (int t = 0; t < data.numTerms; t++) {
+        data.terms[t] = words[t].string;
+        data.postingOffsets[t + 1] = data.postingOffsets[t] +
+            builder->postings[words[t].id].numPages;
+    }
+    statsSet(STATS_TERMS, data.numTerms);
+    statsSet(STATS_POSTINGS, data.postingOffsets[data.numTerms]);
+
+    data.postings = malloc((data.postingOffsets[data.numTerms] + 1) *
+        sizeof(uint32_t));
+    if (data.postings == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int t = 0; t < data.numTerms; t++) {
+        struct Postings *postings = &builder->postings[words[t].id];
+        for (int j = 0; j < postings->numPages; j++) {
+            data.postings[data.postingOffsets[t] + j] = postings->pages[j];
+        }
+    }
+
+    // Copies the PageRank values given, or those of pagerankList.txt if
+    // pagerank has been run
+    if (pageranks != NULL) {
+        for (int i = 0; i < data.numPages; i++) {
+            data.outdegrees[newIds[i]] = outdegrees[i];
+            data.pageranks[newIds[i]] = pageranks[i];
+        }
+        data.hasRanks = 1;
+    } else {
+        readPageranks(RANK_LIST_FILE_NAME, urls, newIds, &data);
+    }
+
+    data.rankOrder = 0;
+    if (data.hasRanks) {
+        orderByRank(&data);
+    }
+
+    // The text files are finished by now, so a reader can tell whether
+    // either is written again after the index
+    indexSourceRead("invertedIndex.txt", &data.textIndex);
+    indexSourceRead(RANK_LIST_FILE_NAME, &data.rankList);
+    indexFileWrite(filename, &data);
+
+    free(data.urls);
+    free(data.outdegrees);
+    free(data.pageranks);
+    free(data.terms);
+    free(data.postingOffsets);
+    free(data.postings);
+}
+
+// Reads the outdegrees and PageRank values from the pagerankList file
+// Does nothing if the file does not exist
+static void readPageranks(
+    const char *filename, struct InternTable *urls, int *newIds,
+    struct IndexData *data
+) {
+    data->hasRanks = 0;
+
+    struct RankListReader reader;
+    if (!rankListOpen(&reader, filename)) {
+        rankListClose(&reader);
+        return;
+    }
+
+    const char *url;
+    int outdegree;
+    double pagerank;
+    while (rankListNext(&reader, &url, &outdegree, &pagerank)) {
+        int page = internTableFind(urls, url);
+        if (page != NOT_FOUND) {
+            data->outdegrees[newIds[page]] = outdegree;
+            data->pageranks[newIds[page]] = pagerank;
+        }
+    }
+
+    data->hasRanks = 1;
+    rankListClose(&reader);
+}
+
+// Numbers the pages again in impact order: in descending order of PageRank
+// value, then alphabetically by URL, the order in which searchPagerank
+// displays pages with the same count
+// The posting lists are sorted into the new order
+static void orderByRank(struct IndexData *data) {
+    struct RankedPage *ranked = malloc((data->numPages + 1) *
+        sizeof(struct RankedPage));
+    int *newIds = malloc((data->numPages + 1) * sizeof(int));
+    if (ranked == NULL || newIds == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < data->numPages; i++) {
+        ranked[i].url = data->urls[i];
+        ranked[i].pagerank = data->pageranks[i];
+        ranked[i].outdegree = data->outdegrees[i];
+        ranked[i].page = i;
+    }
+
+    qsort(ranked, data->numPages, sizeof(struct RankedPage),
+        compareRankedPages);
+
+    for (int i = 0; i < data->numPages; i++) {
+        data->urls[i] = ranked[i].url;
+        data->pageranks[i] = ranked[i].pagerank;
+        data->outdegrees[i] = ranked[i].outdegree;
+        newIds[ranked[i].page] = i;
+    }
+
+    for (int t = 0; t < data->numTerms; t++) {
+        uint64_t start = data->postingOffsets[t];
+        uint64_t length = data->postingOffsets[t + 1] - start;
+        for (uint64_t k = start; k < start + length; k++) {
+            data->postings[k] = newIds[data->postings[k]];
+        }
+
+        qsort(data->postings + start, length, sizeof(uint32_t), compareIds);
+    }
+
+    data->rankOrder = 1;
+    free(ranked);
+    free(newIds);
+}
+
+// Compares two strings alphabetically, for qsort
+static int compareSortedStrings(const void *a, const void *b) {
+    const struct SortedString *stringA = a;
+    const struct SortedString *stringB = b;
+    return strcmp(stringA->string, stringB->string);
+}
+
+// Compares two pages in impact order, for qsort
+static int compareRankedPages(const void *a, const void *b) {
+    const struct RankedPage *pageA = a;
+    const struct RankedPage *pageB = b;
+    if (pageA->pagerank != pageB->pagerank) {
+        return pageA->pagerank > pageB->pagerank ? -1 : 1;
+    }
+
+    return strcmp(pageA->url, pageB->url);
+}
+
+// Compares two IDs in ascending order, for qsort
+static int compareIds(const void *a, const void *b) {
+    int idA = *(const int *)a;
+    int idB = *(const int *)b;
+    return (idA > idB) - (idA < idB);
+}
+
+// Moves the shard at position i of the merge heap down to its place
+static void siftDownShards(
+    int *heap, int size, int i, struct SortedString **words, const int *next
+) {
+    while (1) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = 2 * i + 2;
+        if (left < size && shardBefore(heap[left], heap[smallest], words,
+                next)) {
+            smallest = left;
+        }
+        if (right < size && shardBefore(heap[right], heap[smallest], words,
+                next)) {
+            smallest = right;
+        }
+
+        if (smallest == i) {
+            return;
+        }
+
+        int temp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = temp;
+        i = smallest;
+    }
+}
+
+// Moves the shard at position i of the merge heap up to its place
+static void siftUpShards(
+    int *heap, int i, struct SortedString **words, const int *next
+) {
+    while (i > 0 && shardBefore(heap[i], heap[(i - 1) / 2], words, next)) {
+        int parent = (i - 1) / 2;
+        int temp = heap[i];
+        heap[i] = heap[parent];
+        heap[parent] = temp;
+        i = parent;
+    }
+}
+
+// Returns whether shard a comes before shard b in the merge heap: by their
+// next words, then by shard
+static int shardBefore(
+    int a, int b, struct SortedString **words, const int *next
+) {
+    int order = strcmp(words[a][next[a]].string, words[b][next[b]].string);
+    return order < 0 || (order == 0 && a < b);
+}
@@ -0,0 +1,72 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Inverted Index Builder
+//
+// Description:
+// Builds the inverted index of a collection from the words of its pages, and
+// writes it to "invertedIndex.txt" and, in the binary form described in
+// indexFile.h, to "invertedIndex.bin". Every word is stored once, in a word
+// table of its own, which gives it an ID. The ID of a word is its index in an
+// array of posting lists, each of which stores the IDs of all the URLs in
+// which that particular word has appeared. The pages must be added one after
+// another, so a URL is only appended to a posting list if it is not already
+// the last one there. The words, and the URLs of every posting list, are only
+// sorted once, when the index is written. The posting lists are allocated
+// from an arena (see arena.h), so a posting costs the 4 bytes of its ID and
+// no allocation of its own, and the whole index is freed in one go.
+//
+// Several builders can be filled at the same time, one per thread, each with
+// its own range of pages, and then merged into one.
+
+#ifndef INDEX_BUILDER_H
+#define INDEX_BUILDER_H
+
+#include <stddef.h>
+
+#include "arena.h"
+#include "internTable.h"
+
+// A piece of the posting list of a word
+struct PostingChunk {
+    struct PostingChunk *next;
+    int numPages;
+    int capacity;
+    int pages[];
+};
+
+// The IDs of the URLs containing a word
+// While pages are added they are kept in a list of chunks, each twice the
+// size of the last, up to a limit. When the index is merged or written the
+// chunks are joined into one array, pages, which is NULL until then.
+struct Postings {
+    struct PostingChunk *first;
+    struct PostingChunk *last;
+    int *pages;
+    int numPages;
+};
+
+// The words found so far, and the posting list of each word
+// postings is indexed by the ID of the word in the word table
+// Every chunk and joined posting list is allocated from the arena, and they
+// are all freed together with the builder
+struct IndexBuilder {
+    struct InternTable *words;
+    struct Postings *postings;
+    int capacity;
+    struct Arena arena;
+
+    // The word being normalised
+    char *word;
+    size_t wordCapacity;
+};
+
+struct IndexBuilder *indexBuilderNew(void);
+void indexBuilderFree(struct IndexBuilder *builder);
+
+void indexBuilderAddWord(struct IndexBuilder *builder, const char *chars,
+    size_t length, int page);
+struct IndexBuilder *indexBuilderMerge(struct IndexBuilder **shards,
+    int numShards);
+void indexBuilderWrite(struct IndexBuilder *builder, struct InternTable *urls,
+    int *outdegrees, double *pageranks, int numThreads);
+
+#endif
@@ -0,0 +1,340 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Binary Index File
+//
+// Description:
+// Writes and maps the binary index file described in indexFile.h. The writer
+// lays the sections out one after another, padding each to 8 bytes. The
+// reader maps the whole file read-only and checks that every section lies
+// inside it before handing out pointers into the mapping.
+//
+// A running server may have the old index mapped, so the writer never
+// changes it in place: the new index is written to a temporary file next to
+// it, which then replaces it in one rename.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "indexFile.h"
+#include "stats.h"
+
+#define ALIGNMENT 8
+#define TEMP_SUFFIX ".tmp"
+
+static uint64_t align(uint64_t pos);
+static void writeSection(FILE *file, uint64_t *pos, const void *data,
+    size_t size);
+static void writeStrings(FILE *file, uint64_t *pos, const char **strings,
+    int numStrings, uint64_t *offsetsPos, uint64_t *bytesPos);
+static int sectionFits(const struct IndexHeader *header, uint64_t pos,
+    uint64_t size);
+static void *allocOrExit(size_t size);
+
+// Writes the index to the file
+void indexFileWrite(const char *filename, struct IndexData *data) {
+    char *tempName = allocOrExit(strlen(filename) + strlen(TEMP_SUFFIX) + 1);
+    sprintf(tempName, "%s%s", filename, TEMP_SUFFIX);
+
+    FILE *file = fopen(tempName, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening %s\n", tempName);
+        exit(EXIT_FAILURE);
+    }
+
+    struct IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, INDEX_MAGIC);
+    header.version = INDEX_VERSION;
+    header.flags = (data->hasRanks ? INDEX_HAS_RANKS : 0) |
+        (data->rankOrder ? INDEX_RANK_ORDER : 0);
+    header.numPages = data->numPages;
+    header.numTerms = data->numTerms;
+    header.textIndex = data->textIndex;
+    header.rankList = data->rankList;
+
+    // The header is written again at the end, once the offsets are known
+    uint64_t pos = 0;
+    writeSection(file, &pos, &header, sizeof(header));
+
+    writeStrings(file, &pos, data->urls, data->numPages,
+        &header.urlOffsetsPos, &header.urlBytesPos);
+
+    int32_t *outdegrees = allocOrExit((data->numPages + 1) * sizeof(int32_t));
+    double *pageranks = allocOrExit((data->numPages + 1) * sizeof(double));
+
+    for (int i = 0; i < data->numPages; i++) {
+        outdegrees[i] = data->hasRanks ? data->outdegrees[i] : 0;
+        pageranks[i] = data->hasRanks ? data->pageranks[i] : 0;
+    }
+
+    header.outdegreesPos = pos;
+    writeSection(file, &pos, outdegrees, data->numPages * sizeof(int32_t));
+    header.pageranksPos = pos;
+    writeSection(file, &pos, pageranks, data->numPages * sizeof(double));
+    free(outdegrees);
+    free(pageranks);
+
+    writeStrings(file, &pos, data->terms, data->numTerms,
+        &header.termOffsetsPos, &header.termBytesPos);
+
+    header.postingOffsetsPos = pos;
+    writeSection(file, &pos, data->postingOffsets,
+        (data->numTerms + 1) * sizeof(uint64_t));
+
+    struct EncodedPostings encoded;
+    postingsEncode(data->numTerms, data->postingOffsets, data->postings,
+        &encoded);
+    header.blockOffsetsPos = pos;
+    writeSection(file, &pos, encoded.blockOffsets,
+        (data->numTerms + 1) * sizeof(uint64_t));
+    header.blocksPos = pos;
+    writeSection(file, &pos, encoded.blocks,
+        encoded.numBlocks * sizeof(struct PostingBlock));
+    header.postingBytesPos = pos;
+    header.numPostingBytes = encoded.numBytes;
+    writeSection(file, &pos, encoded.bytes, encoded.numBytes);
+    postingsFree(&encoded);
+
+    header.fileSize = pos;
+    int written = fseek(file, 0, SEEK_SET) == 0 &&
+        fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // A failed write of any section leaves the error indicator set
+    written = !ferror(file) && written;
+    if (fclose(file) != 0 || !written || rename(tempName, filename) != 0) {
+        fprintf(stderr, "Error writing %s\n", filename);
+        remove(tempName);
+        exit(EXIT_FAILURE);
+    }
+
+    free(tempName);
+}
+
+// Maps the index file into memory
+// Returns NULL if the file does not exist or is not a valid index file
+struct IndexFile *indexFileOpen(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        (size_t)info.st_size < sizeof(struct IndexHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const struct IndexHeader *header = map;
+    uint64_t numPages = header->numPages;
+    uint64_t numTerms = header->numTerms;
+    if (memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+        header->version != INDEX_VERSION ||
+        header->fileSize != (uint64_t)info.st_size ||
+        !sectionFits(header, header->urlOffsetsPos,
+            (numPages + 1) * sizeof(uint64_t)) ||
+        !sectionFits(header, header->outdegreesPos,
+            numPages * sizeof(int32_t)) ||
+        !sectionFits(header, header->pageranksPos,
+            numPages * sizeof(double)) ||
+        !sectionFits(header, header->termOffsetsPos,
+            (numTerms + 1) * sizeof(uint64_t)) ||
+        !sectionFits(header, header->postingOffsetsPos,
+            (numTerms + 1) * sizeof(uint64_t)) ||
+        !sectionFits(header, header->blockOffsetsPos,
+            (numTerms + 1) * sizeof(uint64_t)) ||
+        !sectionFits(header, header->postingBytesPos,
+            header->numPostingBytes)) {
+        munmap(map, info.st_size);
+        return NULL;
+    }
+
+    struct IndexFile *index = malloc(sizeof(struct IndexFile));
+    if (index == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const char *base = map;
+    index->map = map;
+    index->size = info.st_size;
+    statsAdd(STATS_BYTES_READ, info.st_size);
+    index->header = header;
+    index->numPages = numPages;
+    index->numTerms = numTerms;
+    index->urlOffsets = (const uint64_t *)(base + header->urlOffsetsPos);
+    index->urlBytes = base + header->urlBytesPos;
+    index->outdegrees = (const int32_t *)(base + header->outdegreesPos);
+    index->pageranks = (const double *)(base + header->pageranksPos);
+    index->termOffsets = (const uint64_t *)(base + header->termOffsetsPos);
+    index->termBytes = base + header->termBytesPos;
+
+    struct PostingLists *postings = &index->postings;
+    postings->numTerms = numTerms;
+    postings->postingOffsets =
+        (const uint64_t *)(base + header->postingOffsetsPos);
+    postings->blockOffsets =
+        (const uint64_t *)(base + header->blockOffsetsPos);
+    postings->blocks =
+        (const struct PostingBlock *)(base + header->blocksPos);
+    postings->bytes = (const uint8_t *)(base + header->postingBytesPos);
+
+    // The strings and blocks must also lie inside the file
+    if (!sectionFits(header, header->urlBytesPos,
+            index->urlOffsets[numPages]) ||
+        !sectionFits(header, header->termBytesPos,
+            index->termOffsets[numTerms]) ||
+        !sectionFits(header, header->blocksPos,
+            postings->blockOffsets[numTerms] *
+            sizeof(struct PostingBlock))) {
+        indexFileClose(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+// Unmaps the index file
+void indexFileClose(struct IndexFile *index) {
+    if (index != NULL) {
+        munmap(index->map, index->size);
+        free(index);
+    }
+}
+
+// Finds a term by binary search over the sorted terms
+// Returns its number, or -1 if the index does not contain it
+int indexFileFindTerm(struct IndexFile *index, const char *term) {
+    int lo = 0;
+    int hi = index->numTerms - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(term, indexFileTerm(index, mid));
+        if (cmp == 0) {
+            return mid;
+        } else if (cmp < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    return -1;
+}
+
+// Returns the URL of a page
+const char *indexFileUrl(struct IndexFile *index, int page) {
+    return index->urlBytes + index->urlOffsets[page];
+}
+
+// Returns the text of a term
+const char *indexFileTerm(struct IndexFile *index, int term) {
+    return index->termBytes + index->termOffsets[term];
+}
+
+// Records the size and modification time of a text file, or zeros if there
+// is no such file
+void indexSourceRead(const char *filename, struct IndexSource *source) {
+    struct stat info;
+    memset(source, 0, sizeof(struct IndexSource));
+    if (stat(filename, &info) == 0) {
+        source->size = info.st_size;
+        source->mtimeSec = info.st_mtim.tv_sec;
+        source->mtimeNsec = info.st_mtim.tv_nsec;
+    }
+}
+
+// Returns whether a text file has been written since its size and
+// modification time were recorded
+// A file that no longer exists has not changed anything, so it counts as
+// unchanged
+int indexSourceChanged(
+    const char *filename, const struct IndexSource *source
+) {
+    struct stat info;
+    if (stat(filename, &info) != 0) {
+        return 0;
+    }
+
+    return source->size != (uint64_t)info.st_size ||
+        source->mtimeSec != info.st_mtim.tv_sec ||
+        source->mtimeNsec != info.st_mtim.tv_nsec;
+}
+
+// Rounds a position up to the next multiple of ALIGNMENT
+static uint64_t align(uint64_t pos) {
+    return (pos + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+// Writes one section followed by the padding up to the next section
+static void writeSection(
+    FILE *file, uint64_t *pos, const void *data, size_t size
+) {
+    static const char padding[ALIGNMENT] = {0};
+
+    if (size > 0) {
+        fwrite(data, 1, size, file);
+    }
+
+    uint64_t end = align(*pos + size);
+    fwrite(padding, 1, end - (*pos + size), file);
+    *pos = end;
+}
+
+// Writes a table of string offsets followed by the strings themselves,
+// each terminated by '\0'
+static void writeStrings(
+    FILE *file, uint64_t *pos, const char **strings, int numStrings,
+    uint64_t *offsetsPos, uint64_t *bytesPos
+) {
+    uint64_t *offsets = malloc((numStrings + 1) * sizeof(uint64_t));
+    if (offsets == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    offsets[0] = 0;
+    for (int i = 0; i < numStrings; i++) {
+        offsets[i + 1] = offsets[i] + strlen(strings[i]) + 1;
+    }
+
+    *offsetsPos = *pos;
+    writeSection(file, pos, offsets, (numStrings + 1) * sizeof(uint64_t));
+
+    *bytesPos = *pos;
+    for (int i = 0; i < numStrings; i++) {
+        fwrite(strings[i], 1, offsets[i + 1] - offsets[i], file);
+    }
+    *pos += offsets[numStrings];
+    writeSection(file, pos, NULL, 0);
+
+    free(offsets);
+}
+
+// Checks that a section of the given size lies inside the file
+static int sectionFits(
+    const struct IndexHeader *header, uint64_t pos, uint64_t size
+) {
+    return pos <= header->fileSize && size <= header->fileSize - pos;
+}
+
+// Allocates memory and exits if there is none left
+static void *allocOrExit(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
@@ -0,0 +1,122 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Binary Index File
+//
+// Description:
+// A binary form of the inverted index, written by invertedIndex next to
+// invertedIndex.txt and memory-mapped by searchPagerank, so that a query
+// needs no parsing at all. The file holds:
+//     - the URLs of all the pages, so the ID of a page is its position in
+//       the file. With PageRank values, the pages are in impact order, by
+//       PageRank value then alphabetically by URL (INDEX_RANK_ORDER), and
+//       otherwise in alphabetical order.
+//     - the outdegree and PageRank value of every page, copied from
+//       pagerankList.txt when it was available (INDEX_HAS_RANKS)
+//     - the words, in alphabetical order, found by binary search
+//     - the posting list of every word: the IDs of the pages containing it,
+//       in ascending order, compressed in blocks (see postingCodec.h)
+//     - the size and modification time, to the nanosecond, of
+//       invertedIndex.txt and pagerankList.txt when the index was written,
+//       so a reader can tell whether either has been written again since
+// Every section starts at an offset recorded in the header, aligned to 8
+// bytes. Numbers are stored in the byte order of the machine writing them.
+
+#ifndef INDEX_FILE_H
+#define INDEX_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "postingCodec.h"
+
+#define INDEX_FILE_NAME "invertedIndex.bin"
+#define INDEX_MAGIC "PRINDEX"
+#define INDEX_VERSION 3
+
+#define INDEX_HAS_RANKS 1
+#define INDEX_RANK_ORDER 2
+
+// The size and modification time of a text file the index was written with,
+// all zero if there was no such file
+struct IndexSource {
+    uint64_t size;
+    int64_t mtimeSec;
+    int64_t mtimeNsec;
+};
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t numPages;
+    uint32_t numTerms;
+
+    // Byte offsets of the sections from the start of the file
+    uint64_t urlOffsetsPos;
+    uint64_t urlBytesPos;
+    uint64_t outdegreesPos;
+    uint64_t pageranksPos;
+    uint64_t termOffsetsPos;
+    uint64_t termBytesPos;
+    uint64_t postingOffsetsPos;
+    uint64_t blockOffsetsPos;
+    uint64_t blocksPos;
+    uint64_t postingBytesPos;
+    uint64_t numPostingBytes;
+    uint64_t fileSize;
+
+    // invertedIndex.txt and pagerankList.txt as they were when the index was
+    // written
+    struct IndexSource textIndex;
+    struct IndexSource rankList;
+};
+
+// The index as handed to indexFileWrite
+// postings[postingOffsets[t]] to postings[postingOffsets[t + 1] - 1] are
+// the pages containing term t, and rankOrder is set if the pages are in
+// impact order
+struct IndexData {
+    int numPages;
+    const char **urls;
+    int *outdegrees;
+    double *pageranks;
+    int hasRanks;
+    int rankOrder;
+
+    int numTerms;
+    const char **terms;
+    uint64_t *postingOffsets;
+    uint32_t *postings;
+
+    struct IndexSource textIndex;
+    struct IndexSource rankList;
+};
+
+// A mapped index file, with pointers to each of its sections
+struct IndexFile {
+    void *map;
+    size_t size;
+    const struct IndexHeader *header;
+    int numPages;
+    int numTerms;
+    const uint64_t *urlOffsets;
+    const char *urlBytes;
+    const int32_t *outdegrees;
+    const double *pageranks;
+    const uint64_t *termOffsets;
+    const char *termBytes;
+    struct PostingLists postings;
+};
+
+void indexFileWrite(const char *filename, struct IndexData *data);
+struct IndexFile *indexFileOpen(const char *filename);
+void indexFileClose(struct IndexFile *index);
+
+int indexFileFindTerm(struct IndexFile *index, const char *term);
+const char *indexFileUrl(struct IndexFile *index, int page);
+const char *indexFileTerm(struct IndexFile *index, int term);
+
+void indexSourceRead(const char *filename, struct IndexSource *source);
+int indexSourceChanged(const char *filename,
+    const struct IndexSource *source);
+
+#endif
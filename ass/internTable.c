@@ -0,0 +1,199 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// String Interning Table
+//
+// Description:
+// Implements the interning table declared in internTable.h. Strings are
+// hashed with FNV-1a. The table doubles its slots whenever it becomes more
+// than half full, reusing the stored hashes so no string is hashed twice.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "internTable.h"
+
+#define INITIAL_SLOTS 64
+#define INITIAL_STRINGS 32
+#define INITIAL_BYTES 1024
+
+static unsigned int hashString(const char *str, size_t len);
+static size_t stringLength(struct InternTable *table, int id);
+static int findSlot(struct InternTable *table, const char *str, size_t len,
+    unsigned int hash);
+static void growSlots(struct InternTable *table);
+static void *reallocOrExit(void *ptr, size_t size);
+
+// Creates an empty interning table
+struct InternTable *internTableNew(void) {
+    struct InternTable *table = reallocOrExit(NULL, sizeof(struct InternTable));
+
+    table->bytes = reallocOrExit(NULL, INITIAL_BYTES);
+    table->numBytes = 0;
+    table->byteCapacity = INITIAL_BYTES;
+
+    table->offsets = reallocOrExit(NULL, INITIAL_STRINGS * sizeof(size_t));
+    table->hashes = reallocOrExit(NULL, INITIAL_STRINGS * sizeof(unsigned int));
+    table->numStrings = 0;
+    table->stringCapacity = INITIAL_STRINGS;
+
+    table->slots = reallocOrExit(NULL, INITIAL_SLOTS * sizeof(int));
+    table->numSlots = INITIAL_SLOTS;
+    for (int i = 0; i < table->numSlots; i++) {
+        table->slots[i] = NOT_FOUND;
+    }
+
+    return table;
+}
+
+// Frees the memory allocated to the table and all of its strings
+void internTableFree(struct InternTable *table) {
+    if (table != NULL) {
+        free(table->bytes);
+        free(table->offsets);
+        free(table->hashes);
+        free(table->slots);
+        free(table);
+    }
+}
+
+// Returns the ID of the string, inserting it if it is not in the table yet
+int internTableInsert(struct InternTable *table, const char *str) {
+    return internTableInsertN(table, str, strlen(str));
+}
+
+// Returns the ID of the first len characters of str, which need not be
+// terminated, inserting them if they are not in the table yet
+int internTableInsertN(struct InternTable *table, const char *str, size_t len) {
+    unsigned int hash = hashString(str, len);
+
+    int slot = findSlot(table, str, len, hash);
+    if (table->slots[slot] != NOT_FOUND) {
+        return table->slots[slot];
+    }
+
+    // Copies the string to the end of the arena
+    if (table->numBytes + len + 1 > table->byteCapacity) {
+        while (table->numBytes + len + 1 > table->byteCapacity) {
+            table->byteCapacity *= 2;
+        }
+        table->bytes = reallocOrExit(table->bytes, table->byteCapacity);
+    }
+
+    if (table->numStrings == table->stringCapacity) {
+        table->stringCapacity *= 2;
+        table->offsets = reallocOrExit(table->offsets,
+            table->stringCapacity * sizeof(size_t));
+        table->hashes = reallocOrExit(table->hashes,
+            table->stringCapacity * sizeof(unsigned int));
+    }
+
+    int id = table->numStrings;
+    memcpy(table->bytes + table->numBytes, str, len);
+    table->bytes[table->numBytes + len] = '\0';
+    table->offsets[id] = table->numBytes;
+    table->hashes[id] = hash;
+    table->numBytes += len + 1;
+    table->numStrings++;
+
+    table->slots[slot] = id;
+
+    // Keeps the load factor below one half
+    if (table->numStrings * 2 > table->numSlots) {
+        growSlots(table);
+    }
+
+    return id;
+}
+
+// Returns the ID of the string, or NOT_FOUND if it is not in the table
+int internTableFind(struct InternTable *table, const char *str) {
+    return internTableFindN(table, str, strlen(str));
+}
+
+// Returns the ID of the first len characters of str, which need not be
+// terminated, or NOT_FOUND if they are not in the table
+int internTableFindN(struct InternTable *table, const char *str, size_t len) {
+    int slot = findSlot(table, str, len, hashString(str, len));
+    return table->slots[slot];
+}
+
+// Returns the string with the given ID
+// The pointer is only valid until the next insertion
+const char *internTableString(struct InternTable *table, int id) {
+    return table->bytes + table->offsets[id];
+}
+
+// Returns the number of strings in the table
+int internTableSize(struct InternTable *table) {
+    return table->numStrings;
+}
+
+// Computes the FNV-1a hash of the string
+static unsigned int hashString(const char *str, size_t len) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// Returns the length of the string with the given ID
+// The strings are stored back to back, so it ends where the next one starts
+static size_t stringLength(struct InternTable *table, int id) {
+    size_t end = id + 1 < table->numStrings ? table->offsets[id + 1] :
+        table->numBytes;
+    return end - table->offsets[id] - 1;
+}
+
+// Finds the slot holding the string, or the empty slot where it belongs
+static int findSlot(
+    struct InternTable *table, const char *str, size_t len, unsigned int hash
+) {
+    int mask = table->numSlots - 1;
+    int slot = hash & mask;
+
+    while (table->slots[slot] != NOT_FOUND) {
+        int id = table->slots[slot];
+        const char *other = table->bytes + table->offsets[id];
+        if (table->hashes[id] == hash && stringLength(table, id) == len &&
+            memcmp(other, str, len) == 0) {
+            return slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+// Doubles the number of slots and re-inserts every ID
+static void growSlots(struct InternTable *table) {
+    free(table->slots);
+    table->numSlots *= 2;
+    table->slots = reallocOrExit(NULL, table->numSlots * sizeof(int));
+    for (int i = 0; i < table->numSlots; i++) {
+        table->slots[i] = NOT_FOUND;
+    }
+
+    int mask = table->numSlots - 1;
+    for (int id = 0; id < table->numStrings; id++) {
+        int slot = table->hashes[id] & mask;
+        while (table->slots[slot] != NOT_FOUND) {
+            slot = (slot + 1) & mask;
+        }
+        table->slots[slot] = id;
+    }
+}
+
+// Reallocates memory and exits if there is none left
+static void *reallocOrExit(void *ptr, size_t size) {
+    ptr = realloc(ptr, size);
+    if (ptr == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
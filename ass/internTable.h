@@ -0,0 +1,44 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// String Interning Table
+//
+// Description:
+// Maps strings (such as URLs) to dense integer IDs 0, 1, 2, ... in the order
+// in which they were first inserted. The lookup is an open addressing hash
+// table with linear probing, and the bytes of all the strings are stored back
+// to back in one growable arena, so each string is stored exactly once.
+
+#ifndef INTERN_TABLE_H
+#define INTERN_TABLE_H
+
+#include <stddef.h>
+
+#define NOT_FOUND -1
+
+struct InternTable {
+    // All the strings, each terminated by '\0'
+    char *bytes;
+    size_t numBytes;
+    size_t byteCapacity;
+
+    // Offset of each string in bytes, and its hash, indexed by ID
+    size_t *offsets;
+    unsigned int *hashes;
+    int numStrings;
+    int stringCapacity;
+
+    // Hash slots holding IDs, NOT_FOUND when empty
+    int *slots;
+    int numSlots;
+};
+
+struct InternTable *internTableNew(void);
+void internTableFree(struct InternTable *table);
+
+int internTableInsert(struct InternTable *table, const char *str);
+int internTableInsertN(struct InternTable *table, const char *str, size_t len);
+int internTableFind(struct InternTable *table, const char *str);
+int internTableFindN(struct InternTable *table, const char *str, size_t len);
+const char *internTableString(struct InternTable *table, int id);
+int internTableSize(struct InternTable *table);
+
+#endif
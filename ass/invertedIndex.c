@@ -7,285 +7,217 @@
 // Written on: 11/01/2024
 //
 // Description:
-// This program reads a collection of URLs from "collection.txt". It processes
-// the content of each URL and extracts all the words appearing in it. It
-// inserts all the words to a binary search tree named indices. Each node in the
-// tree has a linked list which stores all the URLs in which that particular
-// word has appeared. The resulting inverted index is then printed using
-// in-order traversal to the output file, "invertedIndex.txt" in ascending
-// (or alphabetical) order.
+// This program reads a collection of URLs from "collection.txt". Every URL is
+// stored once in a URL table (see internTable.h) and is referred to by its ID.
+// It processes the content of each URL, read in one go by the page scanner
+// (see pageScanner.h), and adds all the words of its Section-2 to the inverted
+// index (see indexBuilder.h). With --pack FILE, the URLs and pages are read
+// from a pack file written by packCollection instead (see collection.h). The
+// resulting inverted index is then printed to the output file,
+// "invertedIndex.txt" in ascending (or alphabetical) order.
+// The same index is also written in the binary form described in indexFile.h
+// to "invertedIndex.bin", together with the PageRank values from
+// "pagerankList.txt" if that file exists, so that searchPagerank can map it
+// instead of parsing text.
+//
+// With --threads N, the pages are split into N ranges of consecutive pages.
+// Each thread reads its own range into an index of its own, and the N indexes
+// are merged before they are written, and the lines of "invertedIndex.txt"
+// are then formatted by the N threads too (see outputWriter.h). The output is
+// the same as with one thread.
+//
+// pagerank --index builds the same index while it reads the links, without
+// reading the pages a second time.
+//
+// With --stats, it prints the times of its phases and a few counters on stderr
+// when it finishes (see stats.h).
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
+#include <pthread.h>
+
+#include "collection.h"
+#include "indexBuilder.h"
+#include "pageScanner.h"
+#include "stats.h"
 
-#define MAX_PAGES 1000
-#define MAX_URL_LENGTH 1000
-#define MAX_WORD_LENGTH 1000
+#define DEFAULT_THREADS 1
 
-struct Pages {
-    char filename[MAX_URL_LENGTH];
-    struct Pages *next;
+// Command-line arguments
+struct Arguments {
+    int numThreads;
+    char *packFile;
 };
 
-struct InvertedIndex {
-    char word[MAX_WORD_LENGTH];
-    struct Pages *fileList;
-    struct InvertedIndex *left;
-    struct InvertedIndex *right;
+// The pages first to last - 1 read by one thread, and the index they go into
+struct IndexWorker {
+    struct Collection *collection;
+    int first;
+    int last;
+    struct IndexBuilder *builder;
 };
 
 // Function Prototypes
-void readCollectionFile(char *filename, struct InvertedIndex **indices);
-void readUrl(char *filename, struct InvertedIndex **indices);
-void normalizeWord(char *word);
-struct InvertedIndex *insertWord(
-    struct InvertedIndex *indices, char *word, char *filename);
-void insertFileName(struct Pages **fileList, char *filename);
-void freeInvertedIndex(struct InvertedIndex *indices);
-void freeFileList(struct Pages *fileList);
-void printInvertedIndex(FILE *file, struct InvertedIndex *indices);
-
-int main() {
-    // Opens "invertedIndex.txt" in write mode
-    // This is the output file for the inverted index
-    char *filename = "invertedIndex.txt";
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        fprintf(stderr, "Error opening %s\n", filename);
-        exit(EXIT_FAILURE);
-    }
-    
-    struct InvertedIndex *indices = NULL;
+void parseArguments(int argc, char **argv, struct Arguments *args);
+struct IndexBuilder *readPages(struct Collection *collection, int numThreads);
+void *readPageRange(void *arg);
+void readUrl(struct PageScanner *scanner, int page, 
+    struct Collection *collection, struct IndexBuilder *builder);
+
+int main(int argc, char **argv) {
+    struct Arguments args;
+    parseArguments(argc, argv, &args);
 
-    // Opens and reads URLs from the collection file and processes each URL
-    readCollectionFile("collection.txt", &indices);
+    // Times each phase, if ENGINE_STATS is set or --stats is given
+    statsStart("invertedIndex");
+    statsPhase("parse");
+
+    // Opens and reads URLs from the collection file, or the pack file
+    // Gives every URL an ID, so a URL listed twice is only processed once
+    struct Collection *collection = collectionOpen(args.packFile);
+    statsSet(STATS_PAGES, internTableSize(collection->urls));
+
+    // Processes each URL
+    statsPhase("build");
+    struct IndexBuilder *builder = readPages(collection, args.numThreads);
 
     // Prints the inverted indices to the output file
-    // Prints in alphabetical order using in-order traversal
-    printInvertedIndex(file, indices);
+    // Prints in alphabetical order of the words
+    // Also writes the same index in binary form for searchPagerank
+    indexBuilderWrite(builder, collection->urls, NULL, NULL,
+        args.numThreads);
 
-    // Frees the memory allocated to the indices array
+    // Frees the memory allocated to the index and the URL table
     // This prevents memory leaks
-    freeInvertedIndex(indices);
+    indexBuilderFree(builder);
+    collectionFree(collection);
 
-    fclose(file);
+    statsFinish();
 
     return 0;
 }
 
-// Opens and reads the collection file which stores all the URLs
-// It then processes all the URLs iteratively
-void readCollectionFile(char *filename, struct InvertedIndex **indices) {
-    FILE *file = fopen(filename, "r");
-    if (file == NULL) {
-        fprintf(stderr, "Error opening %s\n", filename);
-        exit(EXIT_FAILURE);
+// Reads the optional arguments:
+//     --threads N   reads the pages with N threads
+//     --pack FILE   reads the collection from a pack file
+void parseArguments(int argc, char **argv, struct Arguments *args) {
+    args->numThreads = DEFAULT_THREADS;
+    args->packFile = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            args->numThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+            args->packFile = argv[++i];
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            statsEnable();
+        } else {
+            args->numThreads = 0;
+        }
     }
 
-    char url[MAX_URL_LENGTH];
-    while (fscanf(file, "%s", url) == 1) {
-        // Stores the URL in the newFile array
-        char newFile[MAX_URL_LENGTH];
-        sprintf(newFile, "%s.txt", url);
-
-        // Processes the URL files to stores all the words
-        readUrl(newFile, indices);
+    if (args->numThreads < 1) {
+        fprintf(stderr, "Usage: %s [--threads N] [--pack FILE] [--stats]\n",
+            argv[0]);
+        exit(EXIT_FAILURE);
     }
-
-    fclose(file);
 }
 
+// Reads the words of every page into an index
+// With more than one thread, every thread reads a range of consecutive pages
+// into an index of its own, and these are merged in the order of the ranges
+struct IndexBuilder *readPages(struct Collection *collection, int numThreads) {
+    int numPages = internTableSize(collection->urls);
+    if (numThreads > numPages) {
+        numThreads = numPages > 0 ? numPages : 1;
+    }
 
-// Reads all the words from a specific URL file
-// It normalises the word
-// It updates the indices struct by adding the word to the write position
-void readUrl(char *filename, struct InvertedIndex **indices) {
-    // Opens and the reads the web page
-    FILE *file = fopen(filename, "r");
-    if (file == NULL) {
-        fprintf(stderr, "Error opening '%s'\n", filename);
+    struct IndexWorker *workers = malloc(numThreads * 
+        sizeof(struct IndexWorker));
+    pthread_t *threads = malloc(numThreads * sizeof(pthread_t));
+    if (workers == NULL || threads == NULL) {
+        fprintf(stderr, "error: out of memory\n");
         exit(EXIT_FAILURE);
     }
 
-    int start = 0;
-    char word[MAX_WORD_LENGTH];
-
-    // Firstly, checks where the info of the page starts from
-    // After starting to store the words to the indices struct,
-    // Checks where the info ends
-    while (fscanf(file, "%s", word) == 1) {
-        if (strcmp(word, "#end") == 0) {
-            start = 0;
-        }
-
-        if (start == 1) {
-            //Nomralizes the word and then adds it to the BST
-            normalizeWord(word);
-
-            if (strlen(word) > 0) {
-                *indices = insertWord(*indices, word, filename);
-            }
-        }
-
-        if (strcmp(word, "Section-2") == 0) {
-            start = 1;
-        }
+    for (int t = 0; t < numThreads; t++) {
+        workers[t].collection = collection;
+        workers[t].first = (long)numPages * t / numThreads;
+        workers[t].last = (long)numPages * (t + 1) / numThreads;
+        workers[t].builder = indexBuilderNew();
     }
 
-    fclose(file);
-}
-
-// It normalises the word by
-// removing symbols and punctuations from the end and
-// converts the word to lowercase.
-void normalizeWord(char *word) {
-    int len = strlen(word);
-
-    // Checks particularly for these 6 punctuations in the end of the word
-    // Removes it if it exists
-    // Symbols at start or in the middle of the word are left as it is
-    while (len > 0 && (word[len - 1] == '.' || word[len - 1] == ',' || 
-                       word[len - 1] == ':' || word[len - 1] == ';' || 
-                       word[len - 1] == '?' || word[len - 1] == '*')) {
-        len--;
+    // The calling thread reads the first range itself
+    for (int t = 1; t < numThreads; t++) {
+        if (pthread_create(&threads[t], NULL, readPageRange, &workers[t])) {
+            fprintf(stderr, "error: cannot create thread\n");
+            exit(EXIT_FAILURE);
+        }
     }
 
-    word[len] = '\0';
+    readPageRange(&workers[0]);
 
-    // Converts the word to lower-case
-    for (int i = 0; i < len; i++) {
-        word[i] = tolower(word[i]);
+    for (int t = 1; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
     }
-}
 
-// Inserts the words to the indices struct
-// Updates the BST by comparing strings and inserting in the right place
-// Also inserts the URLs in which the word appears to the word's linked list
-struct InvertedIndex *insertWord(
-    struct InvertedIndex *indices, char *word, char *filename
-) {
-    if (indices == NULL) {
-        indices = (struct InvertedIndex *)malloc(sizeof(struct InvertedIndex));
-        if (indices == NULL) {
+    struct IndexBuilder *builder = workers[0].builder;
+    if (numThreads > 1) {
+        struct IndexBuilder **shards = malloc(numThreads * 
+            sizeof(struct IndexBuilder *));
+        if (shards == NULL) {
             fprintf(stderr, "error: out of memory\n");
             exit(EXIT_FAILURE);
         }
 
-        // Inserts the word to the BST
-        strcpy(indices->word, word);
-        indices->fileList = NULL;
-        indices->left = indices->right = NULL;
-
-        // Inserts the URL in which the word appeared
-        insertFileName(&(indices->fileList), filename);
-    } else {
-        // Compares the words
-        int cmp = strcmp(word, indices->word);
-
-        // Recursively calls the function
-        // Finds the right place for the word to be inserted
-        if (cmp == 0) {
-            insertFileName(&(indices->fileList), filename);
-        } else if (cmp < 0) {
-            indices->left = insertWord(indices->left, word, filename);
-        } else {
-            indices->right = insertWord(indices->right, word, filename);
+        for (int t = 0; t < numThreads; t++) {
+            shards[t] = workers[t].builder;
         }
-    }
 
-    return indices;
-}
-
-// Inserts the URL's name into the list of filenames for a word
-void insertFileName(struct Pages **fileList, char *filename) {
-    // Remvoes the ".txt" from the end of the word
-    // before entering it into the linked list
-    char *extension = strstr(filename, ".txt");
-    if (extension != NULL) {
-        *extension = '\0';
-    }
+        builder = indexBuilderMerge(shards, numThreads);
 
-    // Checks if the particular URL already exists in the list
-    struct Pages *current = *fileList;
-    while (current != NULL) {
-        if (strcmp(current->filename, filename) == 0) {
-            return;
+        for (int t = 0; t < numThreads; t++) {
+            indexBuilderFree(shards[t]);
         }
-
-        current = current->next;
-    }
-    
-    struct Pages *newNode = (struct Pages *)malloc(sizeof(struct Pages));
-    if (newNode == NULL) {
-        fprintf(stderr, "error: out of memory\n");
-        exit(EXIT_FAILURE);
+        free(shards);
     }
 
-    strcpy(newNode->filename, filename);
-    newNode->next = NULL;
+    free(workers);
+    free(threads);
 
-    current = *fileList;
-    struct Pages *prev = NULL;
-
-    // Iteratively finds the place to insert the URL in the list
-    // URLs are to be stored in ascending order (or alphabetical order)
-    while (current != NULL && strcmp(current->filename, filename) < 0) {
-        prev = current;
-        current = current->next;
-    }
-    
-    if (prev == NULL) {
-        newNode->next = *fileList;
-        *fileList = newNode;
-    } else {
-        prev->next = newNode;
-        newNode->next = current;
-    }
+    return builder;
 }
 
-// Frees the memory allocated to the Binary Search Tree
-// and the linked list stored at every node
-void freeInvertedIndex(struct InvertedIndex *indices) {
-    if (indices != NULL) {
-        // Traverses the tree recursively
-        freeInvertedIndex(indices->left);
-        freeInvertedIndex(indices->right);
-
-        freeFileList(indices->fileList);
+// Reads the range of pages of one worker into its index
+void *readPageRange(void *arg) {
+    struct IndexWorker *worker = arg;
 
-        free(indices);
+    // One buffer is reused to read every page
+    struct PageScanner scanner;
+    pageScannerInit(&scanner);
+    for (int page = worker->first; page < worker->last; page++) {
+        readUrl(&scanner, page, worker->collection, worker->builder);
     }
-}
+    pageScannerFree(&scanner);
 
-// Frees the memory allocated for the list of filenames
-void freeFileList(struct Pages *fileList) {
-    while (fileList != NULL) {
-        struct Pages *next = fileList->next;
-        free(fileList);
-        fileList = next;
-    }
+    return NULL;
 }
 
-// Prints the inverted index to the output file, "invertedIndex.txt"
-// Uses in-order traversal to print all the words in alphabetical order
-void printInvertedIndex(FILE *file, struct InvertedIndex *indices) {
-    if (indices != NULL) {
-        // Recursively traverses and prints the left subtree
-        printInvertedIndex(file, indices->left);
-        fprintf(file, "%s", indices->word);
-
-        // Iteratively prints all the URLs associated to the current word
-        struct Pages *current = indices->fileList;
-        while (current != NULL) {
-            fprintf(file, " %s", current->filename);
-            current = current->next;
-        }
-
-        fprintf(file, "\n");
+// Reads all the words from a specific URL file
+// Only the words of Section-2 are added to the index
+void readUrl(
+    struct PageScanner *scanner, int page, struct Collection *collection,
+    struct IndexBuilder *builder
+) {
+    // Opens and the reads the web page
+    collectionOpenPage(collection, page, scanner);
 
-        // Recursively traverses and prints the right subtree
-        printInvertedIndex(file, indices->right);
+    enum PageSection section;
+    struct StringView word;
+    while (pageScannerNext(scanner, &section, &word)) {
+        if (section == SECTION_WORDS) {
+            indexBuilderAddWord(builder, word.chars, word.length, page);
+        }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,299 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Output Writer
+//
+// Description:
+// Implements the output writer declared in outputWriter.h. A double is the
+// integer m times 2^e, so value * 10^p is m * 10^p / 2^-e exactly. For a
+// value below 2^33 and p up to 9, m * 10^p fits in 128 bits, and the
+// rounded quotient, the digits written, fits in 64 bits.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "outputWriter.h"
+
+#define FAST_EXPONENT_LIMIT 33
+
+// A range of items formatted by one thread in a round
+struct OutputChunk {
+    struct OutputWriter writer;
+    int first;
+    int last;
+    void (*writeItem)(struct OutputWriter *writer, int item, void *context);
+    void *context;
+};
+
+static const uint64_t powersOfTen[OUTPUT_MAX_PRECISION + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+};
+
+static void *formatChunk(void *arg);
+static void reserve(struct OutputWriter *writer, size_t length);
+static int formatDigits(char *end, uint64_t value);
+static void writeFixedSlow(struct OutputWriter *writer, double value,
+    int precision);
+
+// Starts writing to a file, or to memory if file is NULL
+void outputWriterOpen(struct OutputWriter *writer, FILE *file) {
+    writer->file = file;
+    writer->size = 0;
+    writer->capacity = OUTPUT_BUFFER_SIZE;
+    writer->buffer = malloc(writer->capacity);
+    if (writer->buffer == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Writes what is in the buffer to the file
+// Does nothing for a writer in memory
+void outputWriterFlush(struct OutputWriter *writer) {
+    if (writer->file == NULL) {
+        return;
+    }
+
+    fwrite(writer->buffer, 1, writer->size, writer->file);
+    writer->size = 0;
+}
+
+// Writes what is left in the buffer and frees it
+// The file itself is left open
+void outputWriterClose(struct OutputWriter *writer) {
+    outputWriterFlush(writer);
+    free(writer->buffer);
+    writer->buffer = NULL;
+    writer->size = 0;
+    writer->capacity = 0;
+}
+
+// Writes length characters, which need not be terminated
+void outputWriteChars(
+    struct OutputWriter *writer, const char *chars, size_t length
+) {
+    reserve(writer, length);
+    memcpy(writer->buffer + writer->size, chars, length);
+    writer->size += length;
+}
+
+// Writes a string
+void outputWriteString(struct OutputWriter *writer, const char *str) {
+    outputWriteChars(writer, str, strlen(str));
+}
+
+// Writes one character
+void outputWriteChar(struct OutputWriter *writer, char c) {
+    reserve(writer, 1);
+    writer->buffer[writer->size++] = c;
+}
+
+// Writes an integer in decimal, as "%lld" does
+void outputWriteInt(struct OutputWriter *writer, long long value) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+
+    // The magnitude is taken as unsigned, so the smallest value fits too
+    uint64_t magnitude = value < 0 ? -(uint64_t)value : (uint64_t)value;
+    int length = formatDigits(end, magnitude);
+    if (value < 0) {
+        end[-++length] = '-';
+    }
+
+    outputWriteChars(writer, end - length, length);
+}
+
+// Writes a number with precision digits after the point, as "%.*f" does
+void outputWriteFixed(
+    struct OutputWriter *writer, double value, int precision
+) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int negative = bits >> 63;
+    int biased = (bits >> 52) & 0x7ff;
+    uint64_t mantissa = bits & (((uint64_t)1 << 52) - 1);
+
+    // Infinities, NaNs and large numbers are left to snprintf
+    if (precision < 0 || precision > OUTPUT_MAX_PRECISION ||
+        biased == 0x7ff || biased - 1023 >= FAST_EXPONENT_LIMIT) {
+        writeFixedSlow(writer, value, precision);
+        return;
+    }
+
+    // value = m * 2^e, subnormal numbers having no implicit leading bit
+    uint64_t m = biased == 0 ? mantissa : mantissa | ((uint64_t)1 << 52);
+    int e = (biased == 0 ? 1 : biased) - 1075;
+
+    // Rounds m * 10^p / 2^-e to the nearest integer, half to even
+    // e is negative, since the value is below 2^33
+    // Anything shifted right by more than 100 bits rounds to 0
+    unsigned __int128 scaled = (unsigned __int128)m * powersOfTen[precision];
+    uint64_t q;
+    if (-e > 100) {
+        q = 0;
+    } else {
+        int shift = -e;
+        q = (uint64_t)(scaled >> shift);
+        unsigned __int128 rest = scaled - ((unsigned __int128)q << shift);
+        unsigned __int128 half = (unsigned __int128)1 << (shift - 1);
+        if (rest > half || (rest == half && (q & 1))) {
+            q++;
+        }
+    }
+
+    char digits[48];
+    char *end = digits + sizeof(digits);
+    int length = 0;
+    if (precision > 0) {
+        uint64_t fraction = q % powersOfTen[precision];
+        int fractionLength = formatDigits(end, fraction);
+        while (fractionLength < precision) {
+            end[-++fractionLength] = '0';
+        }
+        length = fractionLength;
+        end[-++length] = '.';
+    }
+
+    length += formatDigits(end - length, q / powersOfTen[precision]);
+
+    // printf keeps the sign of a negative number that rounds to 0
+    if (negative) {
+        end[-++length] = '-';
+    }
+
+    outputWriteChars(writer, end - length, length);
+}
+
+// Writes numItems items to the file, numThreads chunks at a time
+// writeItem writes item i to the writer it is given; items of different
+// chunks are written by different threads at the same time
+void outputWriteParallel(
+    FILE *file, int numItems, int numThreads,
+    void (*writeItem)(struct OutputWriter *writer, int item, void *context),
+    void *context
+) {
+    if (numThreads <= 1 || numItems < OUTPUT_MIN_PARALLEL_ITEMS) {
+        struct OutputWriter writer;
+        outputWriterOpen(&writer, file);
+        for (int i = 0; i < numItems; i++) {
+            writeItem(&writer, i, context);
+        }
+        outputWriterClose(&writer);
+        return;
+    }
+
+    struct OutputChunk *chunks = malloc(numThreads *
+        sizeof(struct OutputChunk));
+    pthread_t *threads = malloc(numThreads * sizeof(pthread_t));
+    if (chunks == NULL || threads == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int t = 0; t < numThreads; t++) {
+        outputWriterOpen(&chunks[t].writer, NULL);
+        chunks[t].writeItem = writeItem;
+        chunks[t].context = context;
+    }
+
+    // The items are shared evenly when there are few of them
+    int chunkItems = (numItems + numThreads - 1) / numThreads;
+    if (chunkItems > OUTPUT_CHUNK_ITEMS) {
+        chunkItems = OUTPUT_CHUNK_ITEMS;
+    }
+
+    for (int start = 0; start < numItems; ) {
+        int numChunks = 0;
+        while (numChunks < numThreads && start < numItems) {
+            struct OutputChunk *chunk = &chunks[numChunks++];
+            chunk->first = start;
+            chunk->last = numItems - start < chunkItems ? numItems :
+                start + chunkItems;
+            start = chunk->last;
+        }
+
+        // The calling thread formats the first chunk itself
+        for (int t = 1; t < numChunks; t++) {
+            if (pthread_create(&threads[t], NULL, formatChunk, &chunks[t])) {
+                fprintf(stderr, "error: cannot create thread\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        formatChunk(&chunks[0]);
+
+        for (int t = 1; t < numChunks; t++) {
+            pthread_join(threads[t], NULL);
+        }
+
+        for (int t = 0; t < numChunks; t++) {
+            fwrite(chunks[t].writer.buffer, 1, chunks[t].writer.size, file);
+            chunks[t].writer.size = 0;
+        }
+    }
+
+    for (int t = 0; t < numThreads; t++) {
+        outputWriterClose(&chunks[t].writer);
+    }
+    free(chunks);
+    free(threads);
+}
+
+// Formats the items of one chunk into its writer
+static void *formatChunk(void *arg) {
+    struct OutputChunk *chunk = arg;
+    for (int i = chunk->first; i < chunk->last; i++) {
+        chunk->writeItem(&chunk->writer, i, chunk->context);
+    }
+
+    return NULL;
+}
+
+// Makes room for length more characters in the buffer
+// A writer on a file writes the buffer out first; the buffer only grows if
+// it is still too small, or if the writer is in memory
+static void reserve(struct OutputWriter *writer, size_t length) {
+    if (writer->size + length <= writer->capacity) {
+        return;
+    }
+
+    outputWriterFlush(writer);
+    if (writer->size + length <= writer->capacity) {
+        return;
+    }
+
+    while (writer->size + length > writer->capacity) {
+        writer->capacity *= 2;
+    }
+    writer->buffer = realloc(writer->buffer, writer->capacity);
+    if (writer->buffer == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Writes the decimal digits of value so that they end just before end
+// Returns the number of digits, at least 1
+static int formatDigits(char *end, uint64_t value) {
+    int length = 0;
+    do {
+        end[-++length] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    return length;
+}
+
+// Writes a number with snprintf, for the numbers outputWriteFixed does not
+// format itself
+static void writeFixedSlow(
+    struct OutputWriter *writer, double value, int precision
+) {
+    int length = snprintf(NULL, 0, "%.*f", precision, value);
+    reserve(writer, length + 1);
+    snprintf(writer->buffer + writer->size, length + 1, "%.*f", precision,
+        value);
+    writer->size += length;
+}
@@ -0,0 +1,58 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Output Writer
+//
+// Description:
+// Writes text output through a large buffer of its own, so a line costs a
+// few copies into the buffer instead of a call to fprintf, with its format
+// parsing and stream locking. Integers and fixed-point numbers are formatted
+// by hand, into exactly the bytes printf writes for "%lld" and "%.*f": a
+// number below 2^33 is rounded from its exact binary value, half to even, as
+// glibc does, and any other number is passed to snprintf.
+//
+// A writer opened on a file writes the buffer out whenever it is full, and
+// when it is closed. A writer opened on NULL keeps everything in memory.
+//
+// outputWriteParallel writes numItems items, such as the lines of a list,
+// with several threads. The items are cut into rounds of numThreads chunks
+// of at most OUTPUT_CHUNK_ITEMS items; in every round each thread formats
+// one chunk into a writer in memory, and the chunks are then written to the
+// file in order, so the file is the same as with one thread. Fewer than
+// OUTPUT_MIN_PARALLEL_ITEMS items are written by the calling thread alone.
+
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define OUTPUT_CHUNK_ITEMS 65536
+#define OUTPUT_MIN_PARALLEL_ITEMS 1024
+#define OUTPUT_MAX_PRECISION 9
+
+struct OutputWriter {
+    // The file written to, or NULL for memory only
+    FILE *file;
+
+    char *buffer;
+    size_t size;
+    size_t capacity;
+};
+
+void outputWriterOpen(struct OutputWriter *writer, FILE *file);
+void outputWriterFlush(struct OutputWriter *writer);
+void outputWriterClose(struct OutputWriter *writer);
+
+void outputWriteChars(struct OutputWriter *writer, const char *chars,
+    size_t length);
+void outputWriteString(struct OutputWriter *writer, const char *str);
+void outputWriteChar(struct OutputWriter *writer, char c);
+void outputWriteInt(struct OutputWriter *writer, long long value);
+void outputWriteFixed(struct OutputWriter *writer, double value,
+    int precision);
+
+void outputWriteParallel(FILE *file, int numItems, int numThreads,
+    void (*writeItem)(struct OutputWriter *writer, int item, void *context),
+    void *context);
+
+#endif
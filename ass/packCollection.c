@@ -0,0 +1,33 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Pack Collection
+//
+// Description:
+// This program reads the collection in the current directory, the URLs of
+// "collection.txt" and the text of every url*.txt page, and writes all of it
+// to a single pack file (see packFile.h), "collection.pack" unless another
+// file name is given. pagerank and invertedIndex then read the collection
+// from the pack file with --pack FILE.
+//
+// Usage: ./packCollection [FILE]
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "collection.h"
+#include "packFile.h"
+
+int main(int argc, char *argv[]) {
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [FILE]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Reads the URLs from collection.txt
+    struct Collection *collection = collectionOpen(NULL);
+
+    packFileWrite(argc > 1 ? argv[1] : PACK_FILE_NAME, collection->urls);
+
+    collectionFree(collection);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,214 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Pack File
+//
+// Description:
+// Writes and maps the pack file described in packFile.h. The pages are
+// copied into the file one at a time, so writing a pack file never holds more
+// than one page in memory. Their offsets are only known once they have all
+// been written, so the page offsets come last in the file.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "packFile.h"
+#include "pageScanner.h"
+#include "stats.h"
+
+#define ALIGNMENT 8
+
+static uint64_t align(uint64_t pos);
+static void writeSection(FILE *file, uint64_t *pos, const void *data,
+    size_t size);
+static int sectionFits(const struct PackHeader *header, uint64_t pos,
+    uint64_t size);
+static void *allocOrExit(size_t size);
+
+// Writes the pack file of the URLs in the table, reading the page of each
+// URL from its url*.txt file
+void packFileWrite(const char *filename, struct InternTable *urls) {
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    int numPages = internTableSize(urls);
+    struct PackHeader header;
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, PACK_MAGIC);
+    header.version = PACK_VERSION;
+    header.numPages = numPages;
+
+    // The header is written again at the end, once the offsets are known
+    uint64_t pos = 0;
+    writeSection(file, &pos, &header, sizeof(header));
+
+    // The URLs are already stored back to back in the table
+    uint64_t *offsets = allocOrExit((numPages + 1) * sizeof(uint64_t));
+    offsets[0] = 0;
+    for (int i = 0; i < numPages; i++) {
+        offsets[i + 1] = offsets[i] + strlen(internTableString(urls, i)) + 1;
+    }
+
+    header.urlOffsetsPos = pos;
+    writeSection(file, &pos, offsets, (numPages + 1) * sizeof(uint64_t));
+    header.urlBytesPos = pos;
+    writeSection(file, &pos, urls->bytes, offsets[numPages]);
+
+    // Copies the pages one at a time
+    struct PageScanner scanner;
+    pageScannerInit(&scanner);
+
+    header.pageBytesPos = pos;
+    offsets[0] = 0;
+    for (int i = 0; i < numPages; i++) {
+        const char *url = internTableString(urls, i);
+        char *pageName = allocOrExit(strlen(url) + 5);
+        sprintf(pageName, "%s.txt", url);
+        if (!pageScannerOpen(&scanner, pageName)) {
+            fprintf(stderr, "Error opening %s\n", pageName);
+            exit(EXIT_FAILURE);
+        }
+        free(pageName);
+
+        fwrite(scanner.text, 1, scanner.size, file);
+        offsets[i + 1] = offsets[i] + scanner.size;
+    }
+    pos += offsets[numPages];
+    writeSection(file, &pos, NULL, 0);
+
+    pageScannerFree(&scanner);
+
+    header.pageOffsetsPos = pos;
+    writeSection(file, &pos, offsets, (numPages + 1) * sizeof(uint64_t));
+    free(offsets);
+
+    header.fileSize = pos;
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+
+    if (fclose(file) != 0) {
+        fprintf(stderr, "Error writing %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Maps the pack file into memory
+// Returns NULL if the file does not exist or is not a valid pack file
+struct PackFile *packFileOpen(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        (size_t)info.st_size < sizeof(struct PackHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const struct PackHeader *header = map;
+    uint64_t numPages = header->numPages;
+    if (memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 ||
+        header->version != PACK_VERSION ||
+        header->fileSize != (uint64_t)info.st_size ||
+        !sectionFits(header, header->urlOffsetsPos,
+            (numPages + 1) * sizeof(uint64_t)) ||
+        !sectionFits(header, header->pageOffsetsPos,
+            (numPages + 1) * sizeof(uint64_t))) {
+        munmap(map, info.st_size);
+        return NULL;
+    }
+
+    struct PackFile *pack = allocOrExit(sizeof(struct PackFile));
+    const char *base = map;
+    pack->map = map;
+    pack->size = info.st_size;
+    statsAdd(STATS_BYTES_READ, info.st_size);
+    pack->numPages = numPages;
+    pack->urlOffsets = (const uint64_t *)(base + header->urlOffsetsPos);
+    pack->urlBytes = base + header->urlBytesPos;
+    pack->pageOffsets = (const uint64_t *)(base + header->pageOffsetsPos);
+    pack->pageBytes = base + header->pageBytesPos;
+
+    // The URLs and pages must also lie inside the file
+    if (!sectionFits(header, header->urlBytesPos,
+            pack->urlOffsets[numPages]) ||
+        !sectionFits(header, header->pageBytesPos,
+            pack->pageOffsets[numPages])) {
+        packFileClose(pack);
+        return NULL;
+    }
+
+    return pack;
+}
+
+// Unmaps the pack file
+void packFileClose(struct PackFile *pack) {
+    if (pack != NULL) {
+        munmap(pack->map, pack->size);
+        free(pack);
+    }
+}
+
+// Returns the URL of a page
+const char *packFileUrl(struct PackFile *pack, int page) {
+    return pack->urlBytes + pack->urlOffsets[page];
+}
+
+// Returns the text of a page, and sets size to its length
+// The text is not terminated by '\0'
+const char *packFilePage(struct PackFile *pack, int page, size_t *size) {
+    *size = pack->pageOffsets[page + 1] - pack->pageOffsets[page];
+    return pack->pageBytes + pack->pageOffsets[page];
+}
+
+// Rounds a position up to the next multiple of ALIGNMENT
+static uint64_t align(uint64_t pos) {
+    return (pos + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+// Writes one section followed by the padding up to the next section
+static void writeSection(
+    FILE *file, uint64_t *pos, const void *data, size_t size
+) {
+    static const char padding[ALIGNMENT] = {0};
+
+    if (size > 0) {
+        fwrite(data, 1, size, file);
+    }
+
+    uint64_t end = align(*pos + size);
+    fwrite(padding, 1, end - (*pos + size), file);
+    *pos = end;
+}
+
+// Checks that a section of the given size lies inside the file
+static int sectionFits(
+    const struct PackHeader *header, uint64_t pos, uint64_t size
+) {
+    return pos <= header->fileSize && size <= header->fileSize - pos;
+}
+
+// Allocates memory and exits if there is none left
+static void *allocOrExit(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
@@ -0,0 +1,63 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Pack File
+//
+// Description:
+// A single file holding a whole collection: the URLs of collection.txt, in
+// order and without repeats, and the text of every url*.txt page. Reading a
+// collection from a pack file means opening and memory-mapping one file
+// instead of one file per page, and the pages are scanned where they lie in
+// the mapping (see pageScanner.h). The file holds:
+//     - the URLs, each terminated by '\0', and the offset of each
+//     - the text of every page, one after another, and the offset of each
+// Every section starts at an offset recorded in the header, aligned to 8
+// bytes. Numbers are stored in the byte order of the machine writing them.
+//
+// packCollection writes the pack file of the collection in the current
+// directory, and pagerank and invertedIndex read it with --pack FILE.
+
+#ifndef PACK_FILE_H
+#define PACK_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "internTable.h"
+
+#define PACK_FILE_NAME "collection.pack"
+#define PACK_MAGIC "PRPACK"
+#define PACK_VERSION 1
+
+struct PackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numPages;
+
+    // Byte offsets of the sections from the start of the file
+    uint64_t urlOffsetsPos;
+    uint64_t urlBytesPos;
+    uint64_t pageOffsetsPos;
+    uint64_t pageBytesPos;
+    uint64_t fileSize;
+};
+
+// A mapped pack file, with pointers to each of its sections
+// The text of page i is pageBytes[pageOffsets[i]] to
+// pageBytes[pageOffsets[i + 1] - 1]
+struct PackFile {
+    void *map;
+    size_t size;
+    int numPages;
+    const uint64_t *urlOffsets;
+    const char *urlBytes;
+    const uint64_t *pageOffsets;
+    const char *pageBytes;
+};
+
+void packFileWrite(const char *filename, struct InternTable *urls);
+struct PackFile *packFileOpen(const char *filename);
+void packFileClose(struct PackFile *pack);
+
+const char *packFileUrl(struct PackFile *pack, int page);
+const char *packFilePage(struct PackFile *pack, int page, size_t *size);
+
+#endif
@@ -0,0 +1,173 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Page Scanner
+//
+// Description:
+// Implements the page scanner declared in pageScanner.h. Whitespace is found
+// with a lookup table of the characters that fscanf's %s treats as
+// whitespace, so the tokens are the same as those fscanf would read.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "pageScanner.h"
+#include "stats.h"
+
+#define INITIAL_BUFFER 4096
+
+// The whitespace characters of the C locale
+static const unsigned char spaceTable[256] = {
+    [' '] = 1, ['\n'] = 1, ['\t'] = 1, ['\r'] = 1, ['\v'] = 1, ['\f'] = 1
+};
+
+static int viewEquals(struct StringView *view, const char *str);
+static int isSpace(char c);
+
+// Creates a scanner with no page open
+void pageScannerInit(struct PageScanner *scanner) {
+    scanner->text = NULL;
+    scanner->size = 0;
+    scanner->pos = 0;
+    scanner->section = SECTION_NONE;
+    scanner->buffer = NULL;
+    scanner->capacity = 0;
+    arenaInit(&scanner->scratch);
+}
+
+// Frees the buffer of the scanner
+void pageScannerFree(struct PageScanner *scanner) {
+    free(scanner->buffer);
+    arenaFree(&scanner->scratch);
+    pageScannerInit(scanner);
+}
+
+// Reads the whole of a page file into the buffer, ready to be scanned
+// Returns 0 if the file cannot be read
+int pageScannerOpen(struct PageScanner *scanner, const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+
+    size_t size = 0;
+    while (1) {
+        if (size == scanner->capacity) {
+            scanner->capacity = scanner->capacity == 0 ? INITIAL_BUFFER :
+                scanner->capacity * 2;
+            scanner->buffer = realloc(scanner->buffer, scanner->capacity);
+            if (scanner->buffer == NULL) {
+                fprintf(stderr, "error: out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        size_t n = fread(scanner->buffer + size, 1, scanner->capacity - size,
+            file);
+        if (n == 0) {
+            break;
+        }
+        size += n;
+    }
+
+    int ok = !ferror(file);
+    fclose(file);
+    statsAdd(STATS_BYTES_READ, size);
+
+    pageScannerOpenText(scanner, scanner->buffer, size);
+
+    return ok;
+}
+
+// Starts scanning a page that is already in memory
+// The text must stay in place until the next page is opened
+void pageScannerOpenText(
+    struct PageScanner *scanner, const char *text, size_t size
+) {
+    scanner->text = text;
+    scanner->size = size;
+    scanner->pos = 0;
+    scanner->section = SECTION_NONE;
+}
+
+// Finds the next link or word of the page, and sets section to the section
+// it appears in
+// Returns 0 at the end of the page
+int pageScannerNext(
+    struct PageScanner *scanner, enum PageSection *section,
+    struct StringView *token
+) {
+    while (pageScannerNextToken(scanner, token)) {
+        if (token->chars[0] == '#') {
+            // "#start Section-1" and "#start Section-2" open a section
+            // "#end" and the name after it close it
+            if (viewEquals(token, "#start")) {
+                struct StringView name;
+                if (!pageScannerNextToken(scanner, &name)) {
+                    break;
+                } else if (viewEquals(&name, "Section-1")) {
+                    scanner->section = SECTION_LINKS;
+                } else if (viewEquals(&name, "Section-2")) {
+                    scanner->section = SECTION_WORDS;
+                } else {
+                    scanner->section = SECTION_NONE;
+                }
+                continue;
+            }
+
+            if (viewEquals(token, "#end")) {
+                struct StringView name;
+                pageScannerNextToken(scanner, &name);
+                scanner->section = SECTION_NONE;
+                continue;
+            }
+        }
+
+        if (scanner->section != SECTION_NONE) {
+            *section = scanner->section;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Finds the next whitespace-separated token, whatever section it is in
+// Returns 0 at the end of the page
+int pageScannerNextToken(
+    struct PageScanner *scanner, struct StringView *token
+) {
+    const char *text = scanner->text;
+    size_t pos = scanner->pos;
+    size_t size = scanner->size;
+
+    while (pos < size && isSpace(text[pos])) {
+        pos++;
+    }
+
+    if (pos >= size) {
+        scanner->pos = size;
+        return 0;
+    }
+
+    size_t start = pos;
+    while (pos < size && !isSpace(text[pos])) {
+        pos++;
+    }
+
+    token->chars = text + start;
+    token->length = pos - start;
+    scanner->pos = pos;
+
+    return 1;
+}
+
+// Checks whether the view holds exactly the characters of str
+static int viewEquals(struct StringView *view, const char *str) {
+    return strlen(str) == view->length &&
+        memcmp(view->chars, str, view->length) == 0;
+}
+
+// Checks whether c is one of the whitespace characters of the C locale
+static int isSpace(char c) {
+    return spaceTable[(unsigned char)c];
+}
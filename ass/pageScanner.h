@@ -0,0 +1,63 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Page Scanner
+//
+// Description:
+// Splits the text of a web page into tokens at whitespace, byte by byte. The
+// text is either a url*.txt file, read in one go into a buffer that is reused
+// for every page, or a page already in memory, such as a page of a pack file
+// (see packFile.h). Each token is reported together with the section it
+// appears in: the links of Section-1 or the words of Section-2. The "#start"
+// and "#end" lines that mark the sections are never reported.
+//
+// Tokens are returned as views of the text, a pointer and a length, so no
+// token is copied or terminated, and there is no limit on their length. A
+// view is only valid until the next page is opened.
+
+#ifndef PAGE_SCANNER_H
+#define PAGE_SCANNER_H
+
+#include <stddef.h>
+
+#include "arena.h"
+
+enum PageSection {
+    SECTION_NONE,
+    SECTION_LINKS,
+    SECTION_WORDS
+};
+
+// length characters starting at chars, not terminated by '\0'
+struct StringView {
+    const char *chars;
+    size_t length;
+};
+
+struct PageScanner {
+    // The text being scanned
+    const char *text;
+    size_t size;
+    size_t pos;
+    enum PageSection section;
+
+    // The buffer the url*.txt files are read into
+    char *buffer;
+    size_t capacity;
+
+    // Memory for the page being opened, such as its file name, which is
+    // cleared before the next page
+    struct Arena scratch;
+};
+
+void pageScannerInit(struct PageScanner *scanner);
+void pageScannerFree(struct PageScanner *scanner);
+
+int pageScannerOpen(struct PageScanner *scanner, const char *filename);
+void pageScannerOpenText(struct PageScanner *scanner, const char *text,
+    size_t size);
+
+int pageScannerNext(struct PageScanner *scanner, enum PageSection *section,
+    struct StringView *token);
+int pageScannerNextToken(struct PageScanner *scanner,
+    struct StringView *token);
+
+#endif
@@ -8,255 +8,784 @@
 //
 // Description:
 // This program calculates the PageRank values for a collection of web pages
-// stored in a collection file. It calculates the outdegrees for each page by
-// accessing all the URLs. It then calculates the PageRank values of each page
-// using provided parameters such as damping factor, sum of PageRank differences
-// and maximum iterations. The PageRank list is then sorted in the descending
-// order on the basis of the PageRank values. It is then written to a file named
-// "pagerankList.txt" as the output.
+// stored in a collection file. Every URL is given an integer ID through a hash
+// table (see internTable.h), so links are resolved without comparing against
+// every URL in the collection. It reads the outgoing links in Section-1 of
+// every page once, through the page scanner (see pageScanner.h), and stores
+// them in a compressed sparse graph (see graph.h), which also gives the
+// outdegree of each page. With --index, the words in Section-2 of the same
+// pages are added to the inverted index (see indexBuilder.h), which is
+// written after the PageRank list, so invertedIndex need not be run. With
+// --pack FILE, the URLs and pages are read from a pack file written by
+// packCollection (see collection.h). It then calculates the PageRank values of
+// each page using provided parameters such as damping factor, sum of PageRank
+// differences and maximum iterations. Every iteration visits each link once.
+// The PageRank list is then sorted with a merge sort in the descending order on
+// the basis of the PageRank values, and alphabetically by URL for equal
+// values. It is then written to a file named "pagerankList.txt" as the output,
+// through a buffered writer whose lines are formatted by the --threads threads
+// (see outputWriter.h).
+// By default the value of a page without out-links is lost; --dangling spreads
+// it over all pages instead (see rankSolver.h). With --partitions P, the
+// jacobi solver runs in P worker processes, each iterating over one partition
+// of the pages, which splits the work but not the memory (see
+// rankPartition.h). Each --topic adds a PageRank list whose teleport goes to
+// the seed pages of the topic only; all the topics are calculated together,
+// in one pass over the links per iteration.
+// With --stats, it prints the times of its phases and iterations and a few
+// counters on stderr when it finishes (see stats.h).
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
 
+#include "graph.h"
+#include "internTable.h"
+#include "rankSolver.h"
+#include "rankPartition.h"
+#include "collection.h"
+#include "indexBuilder.h"
+#include "rankList.h"
+#include "rankFile.h"
+#include "outputWriter.h"
+#include "stats.h"
+
 #define NO_OF_ARGUMENTS 4
-#define MAX_URL_LENGTH 1000
-#define MAX_PAGES 1000
-#define MAX_PAGE_INFO 1000
+#define DEFAULT_THREADS 1
+#define TOPIC_LIST_FORMAT "pagerankList-%s.txt"
+#define DEFAULT_CHECKPOINT_EVERY 10
 
+// The URL of a page is stored once in the URL table
+// Its ID there is also its index in the pages array
 struct Page {
-    char url[MAX_URL_LENGTH];
+    int id;
     int outdegree;
     double pagerank;
-    int isScanned;
+};
+
+// Command-line arguments
+struct Arguments {
+    struct RankOptions rank;
+    char *warmStartFile;
+    int resume;
+    char *saveRanksFile;
+    char *checkpointFile;
+    int buildIndex;
+    char *packFile;
+    char *personalizationFile;
+
+    // The name and seed file of each topic
+    int numTopics;
+    char **topicNames;
+    char **topicFiles;
+};
+
+// The pages of a PageRank list, in the order they are written
+struct RankListLines {
+    struct InternTable *urls;
+    struct Page *pages;
+    int *order;
+};
+
+// What a checkpoint needs besides the PageRank values
+struct Checkpoint {
+    char *filename;
+    struct InternTable *urls;
+    int *outdegrees;
 };
 
 // Function Prototypes
-void readCollectionFile(char *filename, struct Page *pages, int *numPages);
-void initializeAdjMatrix(int numPages, int adjMatrix[numPages][numPages]);
-void calculateOutdegree(struct Page *pages, int numPages, 
-    int adjMatrix[numPages][numPages]);
-void updateAdjMatrix(char filename[MAX_URL_LENGTH + 4], struct Page *pages, 
-    int numPages, int adjMatrix[numPages][numPages], char line[MAX_PAGE_INFO], 
-    int i, int *outdegree);
-void calculatePageRank(struct Page *pages, int numPages, 
-    int adjMatrix[numPages][numPages], 
-    double d, double diffPR, int maxIterations);
-void updatePagerank(struct Page *pages, int numPages, 
-    int adjMatrix[numPages][numPages], double d, 
-    double *pageranks, double *newPageranks);
-void sortPages(struct Page *pages, int numPages);
-void writePageRankList(struct Page *pages, int numPages);
+void parseArguments(int argc, char **argv, struct Arguments *args);
+void printUsage(char *program);
+struct Page *newPages(int numPages);
+struct Graph *readGraph(struct Collection *collection, struct Page *pages, 
+    struct IndexBuilder *builder);
+void readLinks(struct PageScanner *scanner, struct InternTable *urls, int i,
+    int *lastLinkedFrom, struct EdgeList *edges, struct IndexBuilder *builder);
+int *sortPages(struct InternTable *urls, struct Page *pages, int numPages);
+int comparePages(struct InternTable *urls, struct Page *a, struct Page *b);
+int readWarmStart(char *filename, struct InternTable *urls, 
+    double d, double *pageranks);
+void writeCheckpoint(void *context, const double *pageranks, int iteration);
+double *readPersonalization(char *filename, struct InternTable *urls);
+void writeTopicLists(struct Arguments *args, struct Graph *graph,
+    struct InternTable *urls, struct Page *pages);
+void writePageRankList(char *filename, struct InternTable *urls, 
+    struct Page *pages, int numPages, int numThreads);
+void writeRankListLine(struct OutputWriter *writer, int i, void *context);
 
 int main(int argc, char **argv) {
-    if (argc != NO_OF_ARGUMENTS) {
-        fprintf(stderr, 
-            "Usage: %s <damping_factor> <diffPR> <maxIterations>\n", argv[0]);
+    // Reads the damping factor, sum of PageRank differences,
+    // maximum number of iterations and the optional flags
+    struct Arguments args;
+    parseArguments(argc, argv, &args);
+
+    // Times each phase, if ENGINE_STATS is set or --stats is given
+    statsStart("pagerank");
+    statsPhase("parse");
+
+    // Reads the collection file, or the pack file
+    // Gives every URL an ID and stores it in the URL table
+    struct Collection *collection = collectionOpen(args.packFile);
+    struct InternTable *urls = collection->urls;
+    int numPages = internTableSize(urls);
+    struct Page *pages = newPages(numPages);
+
+    // Reads the links of every page into the graph
+    // Also calculates the outdegree of each page
+    // With --index, also adds the words of every page to the inverted index
+    struct IndexBuilder *builder = args.buildIndex ? indexBuilderNew() : NULL;
+    struct Graph *graph = readGraph(collection, pages, builder);
+
+    int numDangling = 0;
+    for (int i = 0; i < numPages; i++) {
+        numDangling += graph->outdegree[i] == 0;
+    }
+    statsSet(STATS_PAGES, numPages);
+    statsSet(STATS_EDGES, graph->numEdges);
+    statsSet(STATS_DANGLING_PAGES, numDangling);
+
+    // Calculates the PageRank
+    // Uses the damping factor, sum of PageRank differences and 
+    // maximum number of iterations
+    double *pageranks = malloc((numPages + 1) * sizeof(double));
+    if (pageranks == NULL) {
+        fprintf(stderr, "error: out of memory\n");
         exit(EXIT_FAILURE);
     }
 
-    struct Page pages[MAX_PAGES];
-    int numPages;
+    // Starts from the PageRank values of a previous run, if there is one
+    // A resumed run also counts the iterations done before the checkpoint
+    if (args.warmStartFile != NULL) {
+        int done = readWarmStart(args.warmStartFile, urls, args.rank.d, 
+            pageranks);
+        if (args.resume) {
+            args.rank.startIteration = done;
+        }
+    }
 
-    // Reads the collection file
-    // Stores the URLs and the number of URLs
-    readCollectionFile("collection.txt", pages, &numPages);
+    // Saves the values every few iterations, if asked to
+    struct Checkpoint checkpoint = {args.checkpointFile, urls, 
+        graph->outdegree};
+    if (args.checkpointFile != NULL) {
+        args.rank.checkpoint = writeCheckpoint;
+        args.rank.checkpointContext = &checkpoint;
+    }
 
-    int adjMatrix[MAX_PAGES][MAX_PAGES];
-    // Initializes the adjacency matrix
-    // Assigns zero to each and every value
-    initializeAdjMatrix(numPages, adjMatrix);
+    // Reads the weights the value of the dangling pages is spread by
+    double *personalization = NULL;
+    if (args.personalizationFile != NULL) {
+        personalization = readPersonalization(args.personalizationFile, urls);
+        args.rank.personalization = personalization;
+    }
 
-    // Calculates the outdegree of each page and updates the adjacency matrix
-    calculateOutdegree(pages, numPages, adjMatrix);
+    statsPhase("iterate");
+    int iterations = calculatePageRank(graph, &args.rank, pageranks);
 
-    // Calculates the PageRank
-    // Uses the damping factor, sum of PageRank differences and 
-    // maximum number of iterations
-    calculatePageRank(pages, numPages, adjMatrix, 
-        atof(argv[1]), atof(argv[2]), atoi(argv[3]));
+    // Stores the PageRank value to the pages array 
+    for (int i = 0; i < numPages; i++) {
+        pages[i].pagerank = pageranks[i];
+    }
 
     // Write the sorted PageRank list to a pagerankList.txt
-    writePageRankList(pages, numPages);
+    writePageRankList(RANK_LIST_FILE_NAME, urls, pages, numPages,
+        args.rank.numThreads);
+
+    // Also writes the exact values, if asked to
+    if (args.saveRanksFile != NULL) {
+        rankFileWrite(args.saveRanksFile, urls, graph->outdegree, pageranks,
+            iterations);
+    }
+
+    // Writes the inverted index after the PageRank list, so the binary index
+    // records the list it was written with
+    // The values are rounded as in the list, so searchPagerank orders the
+    // results the same way from either file
+    if (builder != NULL) {
+        for (int i = 0; i < numPages; i++) {
+            char value[64];
+            snprintf(value, sizeof(value), "%.7lf", pageranks[i]);
+            pageranks[i] = atof(value);
+        }
+
+        indexBuilderWrite(builder, urls, graph->outdegree, pageranks,
+            args.rank.numThreads);
+        indexBuilderFree(builder);
+    }
+
+    // Calculates the PageRank of every topic in one batch, and writes one
+    // more list per topic
+    if (args.numTopics > 0) {
+        writeTopicLists(&args, graph, urls, pages);
+    }
+
+    free(pageranks);
+    free(personalization);
+    free(args.topicNames);
+    free(args.topicFiles);
+
+    graphFree(graph);
+    collectionFree(collection);
+    free(pages);
+
+    statsFinish();
 
     return 0;
 }
 
-// Read the collection file
-// Stores the URLs and the number of URLs
-void readCollectionFile(char *filename, struct Page *pages, int *numPages) {
-    // Opens the file collection.txt which stores all the URLs
-    FILE *file = fopen(filename, "r");
-    if (file == NULL) {
-        fprintf(stderr, "Error opening %s", filename);
+// Reads the command-line arguments
+// The three required arguments may be followed by:
+//     --threads N         splits every iteration between N threads
+//     --solver NAME       jacobi (default), gauss-seidel, adaptive or push
+//     --warm-start FILE   starts from the PageRank values in FILE, a
+//                         pagerankList.txt written by an earlier run
+//     --incremental FILE  the same as --warm-start FILE --solver push, which
+//                         only does work around the pages that changed
+//     --resume FILE       carries on from a checkpoint: the same as
+//                         --warm-start FILE, but the iterations done before
+//                         the checkpoint count towards maxIterations
+//     --checkpoint FILE   saves the values to the binary rank file FILE (see
+//                         rankFile.h) every few iterations
+//     --checkpoint-every N
+//                         saves a checkpoint every N iterations (default 10)
+//     --save-ranks FILE   also writes the exact values to the binary rank
+//                         file FILE, which --warm-start and searchPagerank
+//                         --ranks can read
+//     --index             also writes the inverted index, as invertedIndex
+//                         does, from the same reading of the pages
+//     --pack FILE         reads the collection from a pack file
+//     --kernel NAME       auto (default), scalar or avx2, the inner loops of
+//                         the jacobi solver
+//     --dangling MODE     leak (default), uniform or personalized, what
+//                         happens to the value of pages without out-links
+//     --personalization FILE
+//                         the weights for --dangling personalized, one URL
+//                         per line, each optionally followed by its weight
+//     --topic NAME FILE   also calculates the PageRank of topic NAME, whose
+//                         teleport weights are read from FILE as for
+//                         --personalization, and writes it to
+//                         pagerankList-NAME.txt; may be given many times
+//     --partitions P      runs the jacobi solver in P worker processes, one
+//                         per partition of the pages; P (P + 1) sockets must
+//                         fit under the hard limit on open files
+//     --partitioner NAME  locality (default), range or hash, how the pages
+//                         are split between the partitions
+void parseArguments(int argc, char **argv, struct Arguments *args) {
+    if (argc < NO_OF_ARGUMENTS) {
+        printUsage(argv[0]);
+    }
+
+    struct RankOptions *options = &args->rank;
+    args->warmStartFile = NULL;
+    args->resume = 0;
+    args->saveRanksFile = NULL;
+    args->checkpointFile = NULL;
+    args->buildIndex = 0;
+    args->packFile = NULL;
+    args->personalizationFile = NULL;
+    args->numTopics = 0;
+    args->topicNames = malloc(argc * sizeof(char *));
+    args->topicFiles = malloc(argc * sizeof(char *));
+    if (args->topicNames == NULL || args->topicFiles == NULL) {
+        fprintf(stderr, "error: out of memory\n");
         exit(EXIT_FAILURE);
     }
+    options->warmStart = 0;
+
+    options->d = atof(argv[1]);
+    options->diffPR = atof(argv[2]);
+    options->maxIterations = atoi(argv[3]);
+    options->numThreads = DEFAULT_THREADS;
+    options->solver = SOLVER_JACOBI;
+    options->kernel = KERNEL_AUTO;
+    options->dangling = DANGLING_LEAK;
+    options->personalization = NULL;
+    options->numPartitions = 1;
+    options->partitioner = PARTITION_LOCALITY;
+    options->startIteration = 0;
+    options->checkpointEvery = DEFAULT_CHECKPOINT_EVERY;
+    options->checkpoint = NULL;
+    options->checkpointContext = NULL;
+
+    for (int i = NO_OF_ARGUMENTS; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options->numThreads = atoi(argv[++i]);
+            if (options->numThreads < 1) {
+                fprintf(stderr, "Invalid number of threads: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--solver") == 0 && i + 1 < argc) {
+            if (!parseSolverName(argv[++i], &options->solver)) {
+                fprintf(stderr, "Unknown solver: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--warm-start") == 0 && i + 1 < argc) {
+            args->warmStartFile = argv[++i];
+            options->warmStart = 1;
+        } else if (strcmp(argv[i], "--incremental") == 0 && i + 1 < argc) {
+            args->warmStartFile = argv[++i];
+            options->warmStart = 1;
+            options->solver = SOLVER_PUSH;
+        } else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+            args->warmStartFile = argv[++i];
+            args->resume = 1;
+            options->warmStart = 1;
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            args->checkpointFile = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-every") == 0 && 
+            i + 1 < argc) {
+            options->checkpointEvery = atoi(argv[++i]);
+            if (options->checkpointEvery < 1) {
+                fprintf(stderr, "Invalid checkpoint interval: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--save-ranks") == 0 && i + 1 < argc) {
+            args->saveRanksFile = argv[++i];
+        } else if (strcmp(argv[i], "--index") == 0) {
+            args->buildIndex = 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            statsEnable();
+        } else if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+            args->packFile = argv[++i];
+        } else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            if (!parseKernelName(argv[++i], &options->kernel)) {
+                fprintf(stderr, "Unknown kernel: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+            if (rankKernelSelect(options->kernel) == NULL) {
+                fprintf(stderr, "The %s kernel is not supported by this CPU\n",
+                    argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--dangling") == 0 && i + 1 < argc) {
+            if (!parseDanglingName(argv[++i], &options->dangling)) {
+                fprintf(stderr, "Unknown dangling mode: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--personalization") == 0 && 
+            i + 1 < argc) {
+            args->personalizationFile = argv[++i];
+        } else if (strcmp(argv[i], "--topic") == 0 && i + 2 < argc) {
+            args->topicNames[args->numTopics] = argv[++i];
+            args->topicFiles[args->numTopics] = argv[++i];
+            args->numTopics++;
+        } else if (strcmp(argv[i], "--partitions") == 0 && i + 1 < argc) {
+            options->numPartitions = atoi(argv[++i]);
+            if (options->numPartitions < 1) {
+                fprintf(stderr, "Invalid number of partitions: %s\n",
+                    argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--partitioner") == 0 && i + 1 < argc) {
+            if (!parsePartitionName(argv[++i], &options->partitioner)) {
+                fprintf(stderr, "Unknown partitioner: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            printUsage(argv[0]);
+        }
+    }
 
-    // Number of pages are stored using pointers, 
-    // so that it can be used anywhere in the program
-    *numPages = 0;
-    while (fscanf(file, "%s", pages[*numPages].url) == 1) {
-        (*numPages)++;
+    if ((options->dangling == DANGLING_PERSONALIZED) != 
+        (args->personalizationFile != NULL)) {
+        fprintf(stderr, "--dangling personalized needs --personalization "
+            "FILE, and only it\n");
+        exit(EXIT_FAILURE);
     }
 
-    fclose(file);
+    if (options->solver == SOLVER_PUSH && options->dangling != DANGLING_LEAK) {
+        fprintf(stderr, "The push solver only supports --dangling leak\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if ((options->solver == SOLVER_GAUSS_SEIDEL || 
+         options->solver == SOLVER_PUSH) && options->numThreads > 1) {
+        fprintf(stderr, "The %s solver runs on one thread only\n", 
+            solverName(options->solver));
+        exit(EXIT_FAILURE);
+    }
+
+    // The workers of the partitioned solver run the jacobi iteration on
+    // one thread each, and keep no checkpoints
+    if (options->numPartitions > 1 && (options->solver != SOLVER_JACOBI ||
+        options->numThreads > 1 || args->checkpointFile != NULL)) {
+        fprintf(stderr, "--partitions only works with the jacobi solver on "
+            "one thread, without --checkpoint\n");
+        exit(EXIT_FAILURE);
+    }
 }
 
-// Initializes the adjacency matrix
-void initializeAdjMatrix(int numPages, int adjMatrix[numPages][numPages]) {
+// Prints how to run the program and exits
+void printUsage(char *program) {
+    fprintf(stderr, "Usage: %s <damping_factor> <diffPR> <maxIterations> "
+        "[--threads N] [--solver jacobi|gauss-seidel|adaptive|push] "
+        "[--warm-start FILE] [--incremental FILE] [--resume FILE] "
+        "[--checkpoint FILE] [--checkpoint-every N] [--save-ranks FILE] "
+        "[--index] "
+        "[--pack FILE] [--kernel auto|scalar|avx2] "
+        "[--dangling leak|uniform|personalized] "
+        "[--personalization FILE] [--topic NAME FILE]... "
+        "[--partitions P] [--partitioner locality|range|hash] [--stats]\n",
+        program);
+    exit(EXIT_FAILURE);
+}
+
+// Creates the pages array, for the pages with IDs 0 to numPages - 1
+// There is no limit on the number of pages
+struct Page *newPages(int numPages) {
+    struct Page *pages = malloc((numPages + 1) * sizeof(struct Page));
+    if (pages == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
     for (int i = 0; i < numPages; i++) {
-        for (int j = 0; j < numPages; j++) {
-            // Assigns zero to each and every value
-            adjMatrix[i][j] = 0;
-        }
+        pages[i].id = i;
+        pages[i].outdegree = 0;
+        pages[i].pagerank = 0;
     }
+
+    return pages;
 }
 
-// Calculates the outdegree of each page and updates the adjacency matrix
-void calculateOutdegree(
-    struct Page *pages, int numPages, int adjMatrix[numPages][numPages]
+// Reads the PageRank values of a previous run from a binary rank file, or
+// otherwise from a pagerankList file
+// Pages that were not in the previous run start from (1 - d) / numPages,
+// the value of a page without in-links
+// Pages that are no longer in the collection are ignored
+// Returns the number of iterations recorded in the rank file, or 0 for a
+// pagerankList file
+int readWarmStart(
+    char *filename, struct InternTable *urls, double d, double *pageranks
 ) {
+    int numPages = internTableSize(urls);
     for (int i = 0; i < numPages; i++) {
-        int outdegree = 0;
-        char filename[MAX_URL_LENGTH + 4];
-
-        // Stores the URL name stored in the pages array in variable filename
-        snprintf(filename, sizeof(filename), "%s.txt", pages[i].url);
+        pageranks[i] = (1 - d) / numPages;
+    }
 
-        FILE *file = fopen(filename, "r");
-        if (file == NULL) {
-            fprintf(stderr, "Error opening %s\n", filename);
-            exit(EXIT_FAILURE);
+    struct RankFile *ranks = rankFileOpen(filename);
+    if (ranks != NULL) {
+        for (int i = 0; i < ranks->numPages; i++) {
+            int id = internTableFind(urls, rankFileUrl(ranks, i));
+            if (id != NOT_FOUND) {
+                pageranks[id] = ranks->pageranks[i];
+            }
         }
 
-        for (int i = 0; i < numPages; i++) {
-            pages[i].isScanned = 0;
-        }
+        int iteration = ranks->iteration;
+        rankFileClose(ranks);
+        return iteration;
+    }
+
+    struct RankListReader reader;
+    if (!rankListOpen(&reader, filename)) {
+        fprintf(stderr, "Error opening %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
 
-        // Reads all the lines in the current page to calculate the outdegree
-        char line[MAX_PAGE_INFO];
-        while (fscanf(file, "%s", line) == 1) {
-            updateAdjMatrix(filename, pages, numPages, 
-                adjMatrix, line, i, &outdegree);
+    const char *url;
+    int outdegree;
+    double pagerank;
+    while (rankListNext(&reader, &url, &outdegree, &pagerank)) {
+        int id = internTableFind(urls, url);
+        if (id != NOT_FOUND) {
+            pageranks[id] = pagerank;
         }
+    }
 
-        // Stores the outdegree for the current page in the pages array
-        pages[i].outdegree = outdegree;
+    rankListClose(&reader);
 
-        fclose(file);
-    }
+    return 0;
 }
 
-// Helper function to update the adjacency matrix
-void updateAdjMatrix(
-    char filename[MAX_URL_LENGTH + 4], struct Page *pages, int numPages, 
-    int adjMatrix[numPages][numPages], char line[MAX_PAGE_INFO], 
-    int i, int *outdegree
-) {
-    char *extension = strstr(filename, ".txt");
-    if (extension != NULL) {
-        *extension = '\0';
+// Writes a checkpoint of the current PageRank values
+void writeCheckpoint(void *context, const double *pageranks, int iteration) {
+    struct Checkpoint *checkpoint = context;
+    rankFileWrite(checkpoint->filename, checkpoint->urls, 
+        checkpoint->outdegrees, pageranks, iteration);
+}
+
+// Reads the personalization weights from a file
+// Each line holds a URL, optionally followed by its weight (1 by default)
+// URLs that are not in the collection are ignored, and pages that are not
+// listed get no weight
+// Returns the weights of all pages, scaled to add up to 1
+double *readPersonalization(char *filename, struct InternTable *urls) {
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening %s\n", filename);
+        exit(EXIT_FAILURE);
     }
 
-    for (int j = 0; j < numPages; j++) {
-        if (strcmp(line, pages[j].url) == 0 && 
-            strcmp(line, filename) != 0 && 
-            pages[j].isScanned == 0) {
-            pages[j].isScanned = 1;
-            // Increments the outdegree for the current page
-            // Uses pointer to access outdegree afterwards 
-            // to calculate the PageRank
-            adjMatrix[j][i] = 1;
-            (*outdegree)++;
+    int numPages = internTableSize(urls);
+    double *weights = calloc(numPages + 1, sizeof(double));
+    if (weights == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    char *line = NULL;
+    size_t lineSize = 0;
+    double total = 0;
+    ssize_t length;
+    while ((length = getline(&line, &lineSize, file)) != -1) {
+        statsAdd(STATS_BYTES_READ, length);
+        char *rest;
+        char *url = strtok_r(line, " \t\r\n", &rest);
+        if (url == NULL) {
+            continue;
+        }
+
+        char *value = strtok_r(NULL, " \t\r\n", &rest);
+        double weight = value != NULL ? atof(value) : 1;
+        int id = internTableFind(urls, url);
+        if (id != NOT_FOUND && weight > 0) {
+            weights[id] += weight;
+            total += weight;
         }
     }
-}
 
-// Calculates the PageRank of each page
-void calculatePageRank(
-    struct Page *pages, int numPages, int adjMatrix[numPages][numPages], 
-    double d, double diffPR, int maxIterations
-) {
-    double pageranks[numPages];
-    double newPageranks[numPages];
+    free(line);
+    fclose(file);
+
+    if (total == 0) {
+        fprintf(stderr, "%s gives no weight to any page\n", filename);
+        exit(EXIT_FAILURE);
+    }
 
-    // Initialize PageRank values
     for (int i = 0; i < numPages; i++) {
-        pageranks[i] = 1.0 / numPages;
+        weights[i] /= total;
     }
 
-    int iteration = 0;
-    double diff = diffPR;
+    return weights;
+}
 
-    // Iteratively updates the PageRank values
-    while (iteration < maxIterations && diff >= diffPR) {
-        updatePagerank(pages, numPages, adjMatrix, d, pageranks, newPageranks);
+// Calculates the PageRank values of all the topics in one batch
+// Writes the list of each topic to its own file, sorted like pagerankList.txt
+void writeTopicLists(
+    struct Arguments *args, struct Graph *graph, struct InternTable *urls,
+    struct Page *pages
+) {
+    int numPages = internTableSize(urls);
+    int k = args->numTopics;
+    size_t size = ((size_t)numPages * k + 1) * sizeof(double);
+    double *teleports = malloc(size);
+    double *ranks = malloc(size);
+    if (teleports == NULL || ranks == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
 
-        // Calculate the difference between new and old PageRank values
-        diff = 0;
+    // Stores the weights of every topic next to each other for each page
+    for (int t = 0; t < k; t++) {
+        double *weights = readPersonalization(args->topicFiles[t], urls);
         for (int i = 0; i < numPages; i++) {
-            diff += fabs(newPageranks[i] - pageranks[i]);
+            teleports[(size_t)i * k + t] = weights[i];
         }
+        free(weights);
+    }
+
+    statsPhase("iterate");
+    calculatePageRankBatch(graph, &args->rank, k, teleports, ranks);
 
-        // Stores the PageRank value to the pages array 
-        // Updates the PageRank value for the next iteration
+    for (int t = 0; t < k; t++) {
         for (int i = 0; i < numPages; i++) {
-            pageranks[i] = newPageranks[i];
-            pages[i].pagerank = newPageranks[i];
+            pages[i].pagerank = ranks[(size_t)i * k + t];
         }
 
-        iteration++;
+        char *filename = malloc(strlen(TOPIC_LIST_FORMAT) + 
+            strlen(args->topicNames[t]) + 1);
+        if (filename == NULL) {
+            fprintf(stderr, "error: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+
+        sprintf(filename, TOPIC_LIST_FORMAT, args->topicNames[t]);
+        writePageRankList(filename, urls, pages, numPages,
+            args->rank.numThreads);
+        free(filename);
     }
+
+    free(teleports);
+    free(ranks);
 }
 
-// Helper function to update the PageRank values in each iteration
-void updatePagerank(
-    struct Page *pages, int numPages, int adjMatrix[numPages][numPages], 
-    double d, double *pageranks, double *newPageranks
+// Reads the links of every page and builds the graph
+// Also stores the outdegree of each page in the pages array
+// If builder is not NULL, also adds the words of every page to it
+struct Graph *readGraph(
+    struct Collection *collection, struct Page *pages, 
+    struct IndexBuilder *builder
 ) {
+    struct InternTable *urls = collection->urls;
+    int numPages = internTableSize(urls);
+    struct EdgeList edges;
+    edgeListInit(&edges);
+
+    // lastLinkedFrom[j] is the last page found linking to page j
+    // This detects duplicate links without clearing anything between pages
+    int *lastLinkedFrom = malloc((numPages + 1) * sizeof(int));
+    if (lastLinkedFrom == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int j = 0; j < numPages; j++) {
+        lastLinkedFrom[j] = NOT_FOUND;
+    }
+
+    // One buffer is reused to read every page
+    struct PageScanner scanner;
+    pageScannerInit(&scanner);
+
+    for (int i = 0; i < numPages; i++) {
+        collectionOpenPage(collection, i, &scanner);
+        readLinks(&scanner, urls, i, lastLinkedFrom, &edges, builder);
+    }
+
+    pageScannerFree(&scanner);
+    free(lastLinkedFrom);
+
+    // Packs the links into contiguous in-link arrays
+    struct Graph *graph = graphBuild(numPages, &edges);
+    edgeListFree(&edges);
+
+    // Stores the outdegree for every page in the pages array
     for (int i = 0; i < numPages; i++) {
-        newPageranks[i] = (1 - d) / numPages;
+        pages[i].outdegree = graph->outdegree[i];
+    }
+
+    return graph;
+}
 
-        for (int j = 0; j < numPages; j++) {
-            if (adjMatrix[i][j] == 1) {
-                newPageranks[i] += d * pageranks[j] / pages[j].outdegree;
+// Helper function to add the links of page i to the edge list
+// Every token of Section-1 is looked up in the URL table
+// Self links and duplicate links are ignored
+// The words of Section-2 are added to the index builder, if there is one
+void readLinks(
+    struct PageScanner *scanner, struct InternTable *urls, int i, 
+    int *lastLinkedFrom, struct EdgeList *edges, struct IndexBuilder *builder
+) {
+    enum PageSection section;
+    struct StringView token;
+    while (pageScannerNext(scanner, &section, &token)) {
+        if (section == SECTION_WORDS) {
+            if (builder != NULL) {
+                indexBuilderAddWord(builder, token.chars, token.length, i);
             }
+            continue;
+        }
+
+        int j = internTableFindN(urls, token.chars, token.length);
+        if (j != NOT_FOUND && j != i && lastLinkedFrom[j] != i) {
+            lastLinkedFrom[j] = i;
+            // Stores the link from page i to page j
+            edgeListAppend(edges, i, j);
         }
     }
 }
 
 // Writes the sorted PageRank list to a file
-void writePageRankList(struct Page *pages, int numPages) {
+void writePageRankList(
+    char *filename, struct InternTable *urls, struct Page *pages, int numPages,
+    int numThreads
+) {
     // Opens the pagerankList.txt file in write mode
-    FILE *file = fopen("pagerankList.txt", "w");
+    FILE *file = fopen(filename, "w");
     if (file == NULL) {
-        fprintf(stderr, "Error opening pagerankList.txt");
+        fprintf(stderr, "Error opening %s", filename);
         exit(EXIT_FAILURE);
     }
 
     // Sorts the PageRank list on the basis of PageRank
-    sortPages(pages, numPages);
+    statsPhase("sort");
+    int *order = sortPages(urls, pages, numPages);
+    statsPhase("write");
 
     // Writes the list to the txt file as output
-    for (int i = 0; i < numPages; i++) {
-        fprintf(file, "%s, %d, %.7lf\n", 
-            pages[i].url, pages[i].outdegree, pages[i].pagerank);
-    }
+    // The lines are formatted by numThreads threads, and written in order
+    struct RankListLines lines = {urls, pages, order};
+    outputWriteParallel(file, numPages, numThreads, writeRankListLine, &lines);
 
+    free(order);
     fclose(file);
 }
 
-// Sorts the PageRank list using bubble sort
+// Writes the i-th line of a PageRank list: "url, outdegree, pagerank"
+void writeRankListLine(struct OutputWriter *writer, int i, void *context) {
+    struct RankListLines *lines = context;
+    struct Page *page = &lines->pages[lines->order[i]];
+    outputWriteString(writer, internTableString(lines->urls, page->id));
+    outputWriteChars(writer, ", ", 2);
+    outputWriteInt(writer, page->outdegree);
+    outputWriteChars(writer, ", ", 2);
+    outputWriteFixed(writer, page->pagerank, 7);
+    outputWriteChar(writer, '\n');
+}
+
+// Sorts the PageRank list using merge sort
+// Only an array of indices into the pages array is sorted, the pages stay put
 // Sorts in the descending order on the basis of PageRank value
-void sortPages(struct Page *pages, int numPages) {
-    for (int i = 0; i < numPages - 1; i++) {
-        for (int j = 0; j < numPages - i - 1; j++) {
-            if (pages[j].pagerank < pages[j + 1].pagerank) {
-                struct Page temp = pages[j];
-                pages[j] = pages[j + 1];
-                pages[j + 1] = temp;
+// Pages with the same PageRank value are sorted alphabetically by URL
+// Returns the sorted indices
+int *sortPages(struct InternTable *urls, struct Page *pages, int numPages) {
+    int *order = malloc((numPages + 1) * sizeof(int));
+    int *temp = malloc((numPages + 1) * sizeof(int));
+    if (order == NULL || temp == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < numPages; i++) {
+        order[i] = i;
+    }
+
+    // Bottom-up merge sort: merges runs of width 1, 2, 4, ...
+    for (int width = 1; width < numPages; width *= 2) {
+        for (int lo = 0; lo < numPages; lo += 2 * width) {
+            int mid = lo + width < numPages ? lo + width : numPages;
+            int hi = lo + 2 * width < numPages ? lo + 2 * width : numPages;
+            int i = lo;
+            int j = mid;
+            int k = lo;
+
+            while (i < mid && j < hi) {
+                if (comparePages(urls, &pages[order[j]], 
+                    &pages[order[i]]) < 0) {
+                    temp[k++] = order[j++];
+                } else {
+                    temp[k++] = order[i++];
+                }
+            }
+
+            while (i < mid) {
+                temp[k++] = order[i++];
+            }
+
+            while (j < hi) {
+                temp[k++] = order[j++];
             }
         }
+
+        int *swap = order;
+        order = temp;
+        temp = swap;
     }
-}
\ No newline at end of file
+
+    free(temp);
+
+    return order;
+}
+
+// Compares two pages in the order of the PageRank list
+// Returns a negative number if page a comes first, a positive number
+// if page b comes first
+int comparePages(struct InternTable *urls, struct Page *a, struct Page *b) {
+    if (a->pagerank != b->pagerank) {
+        return a->pagerank > b->pagerank ? -1 : 1;
+    }
+
+    return strcmp(internTableString(urls, a->id), 
+        internTableString(urls, b->id));
+}
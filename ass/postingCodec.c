@@ -0,0 +1,266 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Posting Codec
+//
+// Description:
+// Implements the posting codec declared in postingCodec.h. The gaps of a
+// block are packed one after another, each starting at the bit after the
+// last, and every gap is read by loading the 8 bytes that hold it and
+// shifting it into place, so decoding a block has no branches inside it.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "postingCodec.h"
+
+#define INITIAL_BYTES 4096
+#define PADDING 8
+
+static int bitWidth(uint64_t value);
+static void decodeBlock(struct PostingCursor *cursor);
+static void *reallocOrExit(void *ptr, size_t size);
+
+// Compresses the posting lists of every word
+// postings[postingOffsets[t]] to postings[postingOffsets[t + 1] - 1] are the
+// pages of word t, in ascending order
+void postingsEncode(
+    int numTerms, const uint64_t *postingOffsets, const uint32_t *postings,
+    struct EncodedPostings *encoded
+) {
+    uint64_t numBlocks = 0;
+    for (int t = 0; t < numTerms; t++) {
+        uint64_t length = postingOffsets[t + 1] - postingOffsets[t];
+        numBlocks += (length + POSTING_BLOCK_SIZE - 1) / POSTING_BLOCK_SIZE;
+    }
+
+    encoded->blockOffsets = reallocOrExit(NULL,
+        (numTerms + 1) * sizeof(uint64_t));
+    encoded->blocks = reallocOrExit(NULL,
+        (numBlocks + 1) * sizeof(struct PostingBlock));
+    encoded->numBlocks = numBlocks;
+
+    size_t capacity = INITIAL_BYTES;
+    uint8_t *bytes = reallocOrExit(NULL, capacity);
+    uint64_t numBytes = 0;
+    uint64_t block = 0;
+    for (int t = 0; t < numTerms; t++) {
+        encoded->blockOffsets[t] = block;
+
+        uint64_t end = postingOffsets[t + 1];
+        for (uint64_t start = postingOffsets[t]; start < end;
+             start += POSTING_BLOCK_SIZE) {
+            const uint32_t *pages = postings + start;
+            int size = end - start < POSTING_BLOCK_SIZE ? end - start :
+                POSTING_BLOCK_SIZE;
+
+            // The block is packed at the width of its largest gap
+            int width = 0;
+            for (int i = 1; i < size; i++) {
+                int gapWidth = bitWidth(pages[i] - pages[i - 1] - 1);
+                if (gapWidth > width) {
+                    width = gapWidth;
+                }
+            }
+
+            // The bytes after the block are cleared too, since each gap is
+            // written as 8 bytes
+            uint64_t packed = ((uint64_t)(size - 1) * width + 7) / 8;
+            while (numBytes + 1 + packed + PADDING > capacity) {
+                capacity *= 2;
+                bytes = reallocOrExit(bytes, capacity);
+            }
+            memset(bytes + numBytes, 0, 1 + packed + PADDING);
+
+            struct PostingBlock *entry = &encoded->blocks[block++];
+            entry->bytePos = numBytes;
+            entry->firstPage = pages[0];
+            entry->lastPage = pages[size - 1];
+
+            bytes[numBytes] = width;
+            uint8_t *data = bytes + numBytes + 1;
+            for (int i = 1; i < size; i++) {
+                uint64_t bit = (uint64_t)(i - 1) * width;
+                uint64_t word;
+                memcpy(&word, data + bit / 8, sizeof(word));
+                word |= (uint64_t)(pages[i] - pages[i - 1] - 1) << (bit % 8);
+                memcpy(data + bit / 8, &word, sizeof(word));
+            }
+
+            numBytes += 1 + packed;
+        }
+    }
+    encoded->blockOffsets[numTerms] = block;
+
+    // The last gap can then be read as 8 bytes as well
+    memset(bytes + numBytes, 0, PADDING);
+    encoded->bytes = bytes;
+    encoded->numBytes = numBytes + PADDING;
+}
+
+// Frees the memory of posting lists compressed by postingsEncode
+void postingsFree(struct EncodedPostings *encoded) {
+    free(encoded->blockOffsets);
+    free(encoded->blocks);
+    free(encoded->bytes);
+}
+
+// Decodes the posting lists of every word, in full
+// The pages of word t are stored from postings[postingOffsets[t]] on
+void postingsDecode(const struct PostingLists *lists, uint32_t *postings) {
+    struct PostingCursor cursor;
+    for (int t = 0; t < lists->numTerms; t++) {
+        postingCursorOpen(&cursor, lists, t);
+        for (uint64_t k = lists->postingOffsets[t];
+             k < lists->postingOffsets[t + 1]; k++) {
+            postings[k] = postingCursorPage(&cursor);
+            postingCursorNext(&cursor);
+        }
+    }
+}
+
+// Places the cursor at the first page of the posting list of a word
+void postingCursorOpen(
+    struct PostingCursor *cursor, const struct PostingLists *lists, int term
+) {
+    uint64_t firstBlock = lists->blockOffsets[term];
+    cursor->blocks = lists->blocks + firstBlock;
+    cursor->bytes = lists->bytes;
+    cursor->length = lists->postingOffsets[term + 1] -
+        lists->postingOffsets[term];
+    cursor->numBlocks = lists->blockOffsets[term + 1] - firstBlock;
+    cursor->block = 0;
+    cursor->size = 0;
+    cursor->pos = 0;
+
+    if (cursor->numBlocks > 0) {
+        decodeBlock(cursor);
+    }
+}
+
+// Returns the page at the cursor, or POSTING_END if the list is used up
+uint32_t postingCursorPage(struct PostingCursor *cursor) {
+    if (cursor->block == cursor->numBlocks) {
+        return POSTING_END;
+    }
+
+    return cursor->pages[cursor->pos];
+}
+
+// Moves the cursor to the next page of the list
+void postingCursorNext(struct PostingCursor *cursor) {
+    if (cursor->block == cursor->numBlocks) {
+        return;
+    }
+
+    cursor->pos++;
+    if (cursor->pos == cursor->size) {
+        cursor->block++;
+        if (cursor->block < cursor->numBlocks) {
+            decodeBlock(cursor);
+        }
+    }
+}
+
+// Moves the cursor forward to the first page not less than the page given
+// Finds the block first, trying the blocks 1, 2, 4, ... ahead until one
+// ends at or past the page, then searching the last step in halves. Only
+// that block is decoded.
+// Returns the page at the cursor, or POSTING_END if the list is used up
+uint32_t postingCursorSeek(struct PostingCursor *cursor, uint32_t page) {
+    if (cursor->block == cursor->numBlocks) {
+        return POSTING_END;
+    }
+
+    const struct PostingBlock *blocks = cursor->blocks;
+    if (blocks[cursor->block].lastPage < page) {
+        uint64_t start = cursor->block;
+        uint64_t lo = start;
+        uint64_t hi = start;
+        uint64_t step = 1;
+        while (hi < cursor->numBlocks && blocks[hi].lastPage < page) {
+            lo = hi + 1;
+            hi = start + step;
+            step *= 2;
+        }
+
+        if (hi > cursor->numBlocks) {
+            hi = cursor->numBlocks;
+        }
+
+        while (lo < hi) {
+            uint64_t mid = lo + (hi - lo) / 2;
+            if (blocks[mid].lastPage < page) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        cursor->block = lo;
+        if (cursor->block == cursor->numBlocks) {
+            return POSTING_END;
+        }
+        decodeBlock(cursor);
+    }
+
+    // The block ends at or past the page, so the page is found in it
+    int lo = cursor->pos;
+    int hi = cursor->size - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (cursor->pages[mid] < page) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    cursor->pos = lo;
+
+    return cursor->pages[cursor->pos];
+}
+
+// Returns the number of bits needed to hold the value
+static int bitWidth(uint64_t value) {
+    int width = 0;
+    while (value >> width != 0) {
+        width++;
+    }
+
+    return width;
+}
+
+// Decodes the block the cursor is in, and places the cursor at its first
+// page
+static void decodeBlock(struct PostingCursor *cursor) {
+    const struct PostingBlock *block = &cursor->blocks[cursor->block];
+    uint64_t remaining = cursor->length - cursor->block * POSTING_BLOCK_SIZE;
+    cursor->size = remaining < POSTING_BLOCK_SIZE ? remaining :
+        POSTING_BLOCK_SIZE;
+    cursor->pos = 0;
+
+    const uint8_t *data = cursor->bytes + block->bytePos;
+    int width = data[0];
+    uint64_t mask = ((uint64_t)1 << width) - 1;
+    data++;
+
+    uint32_t page = block->firstPage;
+    cursor->pages[0] = page;
+    for (int i = 1; i < cursor->size; i++) {
+        uint64_t bit = (uint64_t)(i - 1) * width;
+        uint64_t word;
+        memcpy(&word, data + bit / 8, sizeof(word));
+        page += ((word >> (bit % 8)) & mask) + 1;
+        cursor->pages[i] = page;
+    }
+}
+
+// Reallocates memory and exits if there is none left
+static void *reallocOrExit(void *ptr, size_t size) {
+    ptr = realloc(ptr, size);
+    if (ptr == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
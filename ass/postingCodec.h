@@ -0,0 +1,76 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Posting Codec
+//
+// Description:
+// Compresses posting lists, and reads them back one page at a time. Each
+// posting list, in ascending order, is cut into blocks of 128 pages. A block
+// records its first and last page, and packs the gaps between its pages at
+// the smallest bit width that holds the largest of them, so a list of pages
+// close together takes a few bits per page instead of 32.
+//
+// A cursor decodes one block at a time. Looking for a page far ahead of the
+// cursor skips whole blocks by their last page, so it decodes a single
+// block, however many pages it passes.
+
+#ifndef POSTING_CODEC_H
+#define POSTING_CODEC_H
+
+#include <stdint.h>
+
+#define POSTING_BLOCK_SIZE 128
+#define POSTING_END UINT32_MAX
+
+// One block of a posting list
+// The bytes from bytePos on hold the bit width, then the gaps packed at that
+// width, less one, from the lowest bit of the first byte up
+struct PostingBlock {
+    uint64_t bytePos;
+    uint32_t firstPage;
+    uint32_t lastPage;
+};
+
+// The compressed posting lists of every word
+// The list of word t holds postingOffsets[t + 1] - postingOffsets[t] pages,
+// in blocks[blockOffsets[t]] to blocks[blockOffsets[t + 1] - 1]
+struct PostingLists {
+    int numTerms;
+    const uint64_t *postingOffsets;
+    const uint64_t *blockOffsets;
+    const struct PostingBlock *blocks;
+    const uint8_t *bytes;
+};
+
+// Posting lists compressed in memory by postingsEncode
+// The bytes end with padding, so every gap can be read as 8 bytes at once
+struct EncodedPostings {
+    uint64_t *blockOffsets;
+    struct PostingBlock *blocks;
+    uint64_t numBlocks;
+    uint8_t *bytes;
+    uint64_t numBytes;
+};
+
+// A position in one posting list, with the block it is in decoded
+struct PostingCursor {
+    const struct PostingBlock *blocks;
+    const uint8_t *bytes;
+    uint64_t length;
+    uint64_t numBlocks;
+    uint64_t block;
+    int size;
+    int pos;
+    uint32_t pages[POSTING_BLOCK_SIZE];
+};
+
+void postingsEncode(int numTerms, const uint64_t *postingOffsets,
+    const uint32_t *postings, struct EncodedPostings *encoded);
+void postingsFree(struct EncodedPostings *encoded);
+void postingsDecode(const struct PostingLists *lists, uint32_t *postings);
+
+void postingCursorOpen(struct PostingCursor *cursor,
+    const struct PostingLists *lists, int term);
+uint32_t postingCursorPage(struct PostingCursor *cursor);
+void postingCursorNext(struct PostingCursor *cursor);
+uint32_t postingCursorSeek(struct PostingCursor *cursor, uint32_t page);
+
+#endif
@@ -0,0 +1,200 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Binary Rank File
+//
+// Description:
+// Writes and maps the rank file described in rankFile.h, laid out like the
+// binary index (see indexFile.c). The URLs are copied straight from the URL
+// table, where they are already stored one after another.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rankFile.h"
+#include "stats.h"
+
+#define ALIGNMENT 8
+#define TEMP_SUFFIX ".tmp"
+
+static uint64_t align(uint64_t pos);
+static void writeSection(FILE *file, uint64_t *pos, const void *data,
+    size_t size);
+static int sectionFits(const struct RankFileHeader *header, uint64_t pos,
+    uint64_t size);
+static void *allocOrExit(size_t size);
+
+// Writes the PageRank values of the pages in the URL table to the file
+// iteration is the number of iterations that gave these values
+void rankFileWrite(
+    const char *filename, struct InternTable *urls, const int *outdegrees,
+    const double *pageranks, int iteration
+) {
+    char *tempName = allocOrExit(strlen(filename) + strlen(TEMP_SUFFIX) + 1);
+    sprintf(tempName, "%s%s", filename, TEMP_SUFFIX);
+
+    FILE *file = fopen(tempName, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening %s\n", tempName);
+        exit(EXIT_FAILURE);
+    }
+
+    int numPages = internTableSize(urls);
+    struct RankFileHeader header;
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, RANK_FILE_MAGIC);
+    header.version = RANK_FILE_VERSION;
+    header.numPages = numPages;
+    header.iteration = iteration;
+
+    // The header is written again at the end, once the offsets are known
+    uint64_t pos = 0;
+    writeSection(file, &pos, &header, sizeof(header));
+
+    uint64_t *offsets = allocOrExit((numPages + 1) * sizeof(uint64_t));
+    offsets[0] = 0;
+    for (int i = 0; i < numPages; i++) {
+        offsets[i + 1] = offsets[i] + strlen(internTableString(urls, i)) + 1;
+    }
+
+    header.urlOffsetsPos = pos;
+    writeSection(file, &pos, offsets, (numPages + 1) * sizeof(uint64_t));
+    header.urlBytesPos = pos;
+    writeSection(file, &pos, urls->bytes, offsets[numPages]);
+    free(offsets);
+
+    int32_t *degrees = allocOrExit((numPages + 1) * sizeof(int32_t));
+    for (int i = 0; i < numPages; i++) {
+        degrees[i] = outdegrees[i];
+    }
+
+    header.outdegreesPos = pos;
+    writeSection(file, &pos, degrees, numPages * sizeof(int32_t));
+    free(degrees);
+
+    header.pageranksPos = pos;
+    writeSection(file, &pos, pageranks, numPages * sizeof(double));
+
+    header.fileSize = pos;
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+
+    if (fclose(file) != 0 || rename(tempName, filename) != 0) {
+        fprintf(stderr, "Error writing %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    free(tempName);
+}
+
+// Maps the rank file into memory
+// Returns NULL if the file does not exist or is not a valid rank file
+struct RankFile *rankFileOpen(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        (size_t)info.st_size < sizeof(struct RankFileHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const struct RankFileHeader *header = map;
+    uint64_t numPages = header->numPages;
+    if (memcmp(header->magic, RANK_FILE_MAGIC, sizeof(RANK_FILE_MAGIC)) != 0 ||
+        header->version != RANK_FILE_VERSION ||
+        header->fileSize != (uint64_t)info.st_size ||
+        !sectionFits(header, header->urlOffsetsPos,
+            (numPages + 1) * sizeof(uint64_t)) ||
+        !sectionFits(header, header->outdegreesPos,
+            numPages * sizeof(int32_t)) ||
+        !sectionFits(header, header->pageranksPos,
+            numPages * sizeof(double))) {
+        munmap(map, info.st_size);
+        return NULL;
+    }
+
+    struct RankFile *ranks = allocOrExit(sizeof(struct RankFile));
+    const char *base = map;
+    ranks->map = map;
+    ranks->size = info.st_size;
+    statsAdd(STATS_BYTES_READ, info.st_size);
+    ranks->numPages = numPages;
+    ranks->iteration = header->iteration;
+    ranks->urlOffsets = (const uint64_t *)(base + header->urlOffsetsPos);
+    ranks->urlBytes = base + header->urlBytesPos;
+    ranks->outdegrees = (const int32_t *)(base + header->outdegreesPos);
+    ranks->pageranks = (const double *)(base + header->pageranksPos);
+
+    // The URLs must also lie inside the file
+    if (!sectionFits(header, header->urlBytesPos,
+            ranks->urlOffsets[numPages])) {
+        rankFileClose(ranks);
+        return NULL;
+    }
+
+    return ranks;
+}
+
+// Unmaps the rank file
+void rankFileClose(struct RankFile *ranks) {
+    if (ranks != NULL) {
+        munmap(ranks->map, ranks->size);
+        free(ranks);
+    }
+}
+
+// Returns the URL of a page
+const char *rankFileUrl(struct RankFile *ranks, int page) {
+    return ranks->urlBytes + ranks->urlOffsets[page];
+}
+
+// Rounds a position up to the next multiple of ALIGNMENT
+static uint64_t align(uint64_t pos) {
+    return (pos + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+// Writes one section followed by the padding up to the next section
+static void writeSection(
+    FILE *file, uint64_t *pos, const void *data, size_t size
+) {
+    static const char padding[ALIGNMENT] = {0};
+
+    if (size > 0) {
+        fwrite(data, 1, size, file);
+    }
+
+    uint64_t end = align(*pos + size);
+    fwrite(padding, 1, end - (*pos + size), file);
+    *pos = end;
+}
+
+// Checks that a section of the given size lies inside the file
+static int sectionFits(
+    const struct RankFileHeader *header, uint64_t pos, uint64_t size
+) {
+    return pos <= header->fileSize && size <= header->fileSize - pos;
+}
+
+// Allocates memory and exits if there is none left
+static void *allocOrExit(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
@@ -0,0 +1,65 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Binary Rank File
+//
+// Description:
+// A binary form of the PageRank values, written by pagerank with
+// --save-ranks FILE and as its checkpoints (--checkpoint FILE). Unlike
+// pagerankList.txt, which rounds every value to 7 decimal places, it keeps
+// the values exactly, so a warm start or a resumed run continues from the
+// same values the solver had. searchPagerank reads it with --ranks FILE. The
+// file holds:
+//     - the number of iterations done so far
+//     - the URLs of all the pages, in the order of their IDs
+//     - the outdegree and PageRank value of every page
+// Every section starts at an offset recorded in the header, aligned to 8
+// bytes. Numbers are stored in the byte order of the machine writing them.
+//
+// The file is written under a temporary name and then renamed, so a run that
+// stops while writing a checkpoint leaves the previous checkpoint in place.
+
+#ifndef RANK_FILE_H
+#define RANK_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "internTable.h"
+
+#define RANK_FILE_MAGIC "PRRANKS"
+#define RANK_FILE_VERSION 1
+
+struct RankFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numPages;
+    uint32_t iteration;
+    uint32_t reserved;
+
+    // Byte offsets of the sections from the start of the file
+    uint64_t urlOffsetsPos;
+    uint64_t urlBytesPos;
+    uint64_t outdegreesPos;
+    uint64_t pageranksPos;
+    uint64_t fileSize;
+};
+
+// A mapped rank file, with pointers to each of its sections
+struct RankFile {
+    void *map;
+    size_t size;
+    int numPages;
+    int iteration;
+    const uint64_t *urlOffsets;
+    const char *urlBytes;
+    const int32_t *outdegrees;
+    const double *pageranks;
+};
+
+void rankFileWrite(const char *filename, struct InternTable *urls,
+    const int *outdegrees, const double *pageranks, int iteration);
+struct RankFile *rankFileOpen(const char *filename);
+void rankFileClose(struct RankFile *ranks);
+
+const char *rankFileUrl(struct RankFile *ranks, int page);
+
+#endif
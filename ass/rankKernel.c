@@ -0,0 +1,235 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// PageRank Kernels
+//
+// Description:
+// Implements the kernels declared in rankKernel.h. The AVX2 functions are
+// compiled for AVX2 through target attributes, so the rest of the program
+// still runs on any x86-64 machine, and they are only chosen if the CPU
+// supports AVX2. Each sum is kept in LANES partial sums, lane l holding the
+// terms at positions l, l + LANES, ..., which are then combined as
+// (lane 0 + lane 2) + (lane 1 + lane 3) before the remaining terms are added
+// one at a time. The scalar functions follow exactly the same order.
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#else
+#define HAVE_AVX2_KERNEL 0
+#endif
+
+#include "rankKernel.h"
+
+#define LANES 4
+
+static void gatherScalar(struct Graph *graph, const double *contributions,
+    double teleport, double *newPageranks, int first, int last);
+static double finishScalar(struct Graph *graph, double d,
+    const double *pageranks, const double *newPageranks,
+    double *contributions, int first, int last);
+static double contribution(double d, double pagerank, int outdegree);
+#if HAVE_AVX2_KERNEL
+static void gatherAvx2(struct Graph *graph, const double *contributions,
+    double teleport, double *newPageranks, int first, int last);
+static double finishAvx2(struct Graph *graph, double d,
+    const double *pageranks, const double *newPageranks,
+    double *contributions, int first, int last);
+static double sumLanes(__m256d sum);
+#endif
+
+static const struct RankKernel scalarKernel = {
+    "scalar", gatherScalar, finishScalar
+};
+
+#if HAVE_AVX2_KERNEL
+static const struct RankKernel avx2Kernel = {
+    "avx2", gatherAvx2, finishAvx2
+};
+#endif
+
+// Returns the kernel for the given mode
+// KERNEL_AUTO picks the fastest kernel the CPU supports
+// Returns NULL if the CPU does not support the kernel asked for
+const struct RankKernel *rankKernelSelect(enum KernelMode mode) {
+    int hasAvx2 = 0;
+#if HAVE_AVX2_KERNEL
+    __builtin_cpu_init();
+    hasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    switch (mode) {
+        case KERNEL_SCALAR:
+            return &scalarKernel;
+        case KERNEL_AVX2:
+#if HAVE_AVX2_KERNEL
+            return hasAvx2 ? &avx2Kernel : NULL;
+#else
+            return NULL;
+#endif
+        default:
+#if HAVE_AVX2_KERNEL
+            return hasAvx2 ? &avx2Kernel : &scalarKernel;
+#else
+            return &scalarKernel;
+#endif
+    }
+}
+
+// Finds the kernel mode with the given name, "auto", "scalar" or "avx2"
+// Returns 1 if there is one, 0 otherwise
+int parseKernelName(const char *name, enum KernelMode *mode) {
+    if (strcmp(name, "auto") == 0) {
+        *mode = KERNEL_AUTO;
+    } else if (strcmp(name, "scalar") == 0) {
+        *mode = KERNEL_SCALAR;
+    } else if (strcmp(name, "avx2") == 0) {
+        *mode = KERNEL_AVX2;
+    } else {
+        return 0;
+    }
+
+    return 1;
+}
+
+// Calculates the new PageRank values of pages first to last - 1
+static void gatherScalar(
+    struct Graph *graph, const double *contributions, double teleport,
+    double *newPageranks, int first, int last
+) {
+    const int *inLinks = graph->inLinks;
+
+    for (int i = first; i < last; i++) {
+        int k = graph->inOffsets[i];
+        int end = graph->inOffsets[i + 1];
+
+        double lanes[LANES] = {0};
+        for (; k + LANES <= end; k += LANES) {
+            for (int l = 0; l < LANES; l++) {
+                lanes[l] += contributions[inLinks[k + l]];
+            }
+        }
+
+        double sum = (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+        for (; k < end; k++) {
+            sum += contributions[inLinks[k]];
+        }
+
+        newPageranks[i] = teleport + sum;
+    }
+}
+
+// Calculates the contributions of the new values of pages first to last - 1
+// Returns the sum of the differences between their new and old values
+static double finishScalar(
+    struct Graph *graph, double d, const double *pageranks,
+    const double *newPageranks, double *contributions, int first, int last
+) {
+    const int *outdegree = graph->outdegree;
+
+    double lanes[LANES] = {0};
+    int i = first;
+    for (; i + LANES <= last; i += LANES) {
+        for (int l = 0; l < LANES; l++) {
+            lanes[l] += fabs(newPageranks[i + l] - pageranks[i + l]);
+            contributions[i + l] = contribution(d, newPageranks[i + l],
+                outdegree[i + l]);
+        }
+    }
+
+    double diff = (lanes[0] + lanes[2]) + (lanes[1] + lanes[3]);
+    for (; i < last; i++) {
+        diff += fabs(newPageranks[i] - pageranks[i]);
+        contributions[i] = contribution(d, newPageranks[i], outdegree[i]);
+    }
+
+    return diff;
+}
+
+// Returns the share of its PageRank value a page gives each of its out-links
+// A page without out-links gives nothing
+static double contribution(double d, double pagerank, int outdegree) {
+    return outdegree > 0 ? d * pagerank / outdegree : 0;
+}
+
+#if HAVE_AVX2_KERNEL
+
+// Calculates the new PageRank values of pages first to last - 1, gathering
+// the contributions of LANES in-links at a time
+__attribute__((target("avx2")))
+static void gatherAvx2(
+    struct Graph *graph, const double *contributions, double teleport,
+    double *newPageranks, int first, int last
+) {
+    const int *inLinks = graph->inLinks;
+
+    for (int i = first; i < last; i++) {
+        int k = graph->inOffsets[i];
+        int end = graph->inOffsets[i + 1];
+
+        __m256d lanes = _mm256_setzero_pd();
+        for (; k + LANES <= end; k += LANES) {
+            __m128i links = _mm_loadu_si128((const __m128i *)(inLinks + k));
+            lanes = _mm256_add_pd(lanes,
+                _mm256_i32gather_pd(contributions, links, sizeof(double)));
+        }
+
+        double sum = sumLanes(lanes);
+        for (; k < end; k++) {
+            sum += contributions[inLinks[k]];
+        }
+
+        newPageranks[i] = teleport + sum;
+    }
+}
+
+// Calculates the contributions of the new values of pages first to last - 1,
+// LANES pages at a time
+// Returns the sum of the differences between their new and old values
+__attribute__((target("avx2")))
+static double finishAvx2(
+    struct Graph *graph, double d, const double *pageranks,
+    const double *newPageranks, double *contributions, int first, int last
+) {
+    const int *outdegree = graph->outdegree;
+    __m256d damping = _mm256_set1_pd(d);
+    __m256d signBit = _mm256_set1_pd(-0.0);
+    __m256d zero = _mm256_setzero_pd();
+
+    __m256d lanes = _mm256_setzero_pd();
+    int i = first;
+    for (; i + LANES <= last; i += LANES) {
+        __m256d newValues = _mm256_loadu_pd(newPageranks + i);
+        __m256d change = _mm256_sub_pd(newValues,
+            _mm256_loadu_pd(pageranks + i));
+        lanes = _mm256_add_pd(lanes, _mm256_andnot_pd(signBit, change));
+
+        // Pages without out-links would divide by zero, their share is
+        // cleared afterwards
+        __m256d degrees = _mm256_cvtepi32_pd(
+            _mm_loadu_si128((const __m128i *)(outdegree + i)));
+        __m256d shares = _mm256_div_pd(_mm256_mul_pd(damping, newValues),
+            degrees);
+        __m256d noLinks = _mm256_cmp_pd(degrees, zero, _CMP_EQ_OQ);
+        _mm256_storeu_pd(contributions + i, _mm256_andnot_pd(noLinks, shares));
+    }
+
+    double diff = sumLanes(lanes);
+    for (; i < last; i++) {
+        diff += fabs(newPageranks[i] - pageranks[i]);
+        contributions[i] = contribution(d, newPageranks[i], outdegree[i]);
+    }
+
+    return diff;
+}
+
+// Adds up the lanes as (lane 0 + lane 2) + (lane 1 + lane 3)
+__attribute__((target("avx2")))
+static double sumLanes(__m256d lanes) {
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(lanes),
+        _mm256_extractf128_pd(lanes, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+#endif
@@ -0,0 +1,42 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// PageRank Kernels
+//
+// Description:
+// The inner loops of a Jacobi iteration, in a scalar version and an AVX2
+// version chosen at run time. Instead of dividing by the outdegree on every
+// link, each iteration first stores the contribution d * PR(j) / outdegree(j)
+// of every page j in a dense array, so a page's new value is the teleport
+// term plus the sum of the contributions of its in-links:
+//     gather  calculates the new values of a range of pages from the
+//             contributions of their in-links
+//     finish  calculates the sum of the differences between the old and new
+//             values of a range of pages, and the contributions of their new
+//             values for the next iteration
+//
+// Both versions add up the same numbers in the same order, in four lanes, so
+// the PageRank values do not depend on the kernel the machine supports.
+
+#ifndef RANK_KERNEL_H
+#define RANK_KERNEL_H
+
+#include "graph.h"
+
+enum KernelMode {
+    KERNEL_AUTO,
+    KERNEL_SCALAR,
+    KERNEL_AVX2
+};
+
+struct RankKernel {
+    const char *name;
+    void (*gather)(struct Graph *graph, const double *contributions,
+        double teleport, double *newPageranks, int first, int last);
+    double (*finish)(struct Graph *graph, double d, const double *pageranks,
+        const double *newPageranks, double *contributions, int first,
+        int last);
+};
+
+const struct RankKernel *rankKernelSelect(enum KernelMode mode);
+int parseKernelName(const char *name, enum KernelMode *mode);
+
+#endif
@@ -0,0 +1,70 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// PageRank List Reader
+//
+// Description:
+// Implements the reader declared in rankList.h. A line is split at its first
+// comma, like fscanf's "%[^,], %d, %lf", and reading stops at the first line
+// that does not hold all three values.
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "rankList.h"
+#include "stats.h"
+
+// Opens a PageRank list for reading
+// Returns 0 if the file cannot be opened
+int rankListOpen(struct RankListReader *reader, const char *filename) {
+    reader->file = fopen(filename, "r");
+    reader->line = NULL;
+    reader->lineSize = 0;
+
+    return reader->file != NULL;
+}
+
+// Closes the list and frees the line buffer
+void rankListClose(struct RankListReader *reader) {
+    if (reader->file != NULL) {
+        fclose(reader->file);
+    }
+    free(reader->line);
+}
+
+// Reads the next line of the list
+// The URL is only valid until the next line is read
+// Returns 0 at the end of the list
+int rankListNext(
+    struct RankListReader *reader, const char **url, int *outdegree,
+    double *pagerank
+) {
+    ssize_t length;
+    while ((length = getline(&reader->line, &reader->lineSize,
+            reader->file)) != -1) {
+        statsAdd(STATS_BYTES_READ, length);
+        char *start = reader->line;
+        while (*start == ' ' || *start == '\t' || *start == '\r' ||
+               *start == '\n') {
+            start++;
+        }
+
+        // Skips blank lines
+        if (*start == '\0') {
+            continue;
+        }
+
+        char *comma = strchr(start, ',');
+        if (comma == NULL || 
+            sscanf(comma + 1, " %d, %lf", outdegree, pagerank) != 2) {
+            return 0;
+        }
+
+        *comma = '\0';
+        *url = start;
+        return 1;
+    }
+
+    return 0;
+}
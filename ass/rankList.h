@@ -0,0 +1,27 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// PageRank List Reader
+//
+// Description:
+// Reads a PageRank list written by pagerank, "pagerankList.txt", one line at
+// a time. Each line holds a URL, its outdegree and its PageRank value,
+// separated by commas. Lines are read whole, so a URL may be of any length.
+
+#ifndef RANK_LIST_H
+#define RANK_LIST_H
+
+#include <stdio.h>
+
+#define RANK_LIST_FILE_NAME "pagerankList.txt"
+
+struct RankListReader {
+    FILE *file;
+    char *line;
+    size_t lineSize;
+};
+
+int rankListOpen(struct RankListReader *reader, const char *filename);
+void rankListClose(struct RankListReader *reader);
+int rankListNext(struct RankListReader *reader, const char **url,
+    int *outdegree, double *pagerank);
+
+#endif
@@ -0,0 +1,955 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Partitioned PageRank Solver
+//
+// Description:
+// Implements the partitioned solver declared in rankPartition.h. The
+// coordinator builds the partitions and the sockets, then forks the workers,
+// which inherit the graph and the starting values. Each worker copies out
+// its own part and from then on touches nothing else. The pages it inherits
+// are shared with the coordinator rather than copied, but the coordinator
+// keeps the whole graph until the end, so no memory is saved.
+//
+// A worker numbers its own pages 0 to numOwned - 1 and its ghosts after
+// them, and stores its in-links under these numbers in a graph of its own,
+// so the kernels of rankKernel.h run on it unchanged. Before the first
+// iteration the workers tell each other which of their pages they need, so
+// each one knows which contributions to send to whom, in the order the other
+// side stores them.
+//
+// Every iteration takes one round trip to the coordinator: each worker
+// reports the difference of its last iteration and the value of its
+// dangling pages, and the coordinator answers with the total value of the
+// dangling pages, or with the order to stop. The reports are added up in
+// the order of the partitions, so the result does not depend on timing. The
+// boundary contributions are then exchanged with every other worker at once,
+// through non-blocking sockets and poll, so no two workers ever wait for
+// each other to read.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "rankPartition.h"
+#include "stats.h"
+
+// Files the coordinator may have open besides the sockets of the workers
+#define RESERVED_FILES 16
+
+// The partition of every page
+// The pages of partition p are pages[offsets[p]] to pages[offsets[p + 1] - 1],
+// in ascending order, and localIndex[i] is the position of page i among the
+// pages of its partition
+struct Partitioning {
+    int numPartitions;
+    int *owner;
+    int *offsets;
+    int *pages;
+    int *localIndex;
+};
+
+// The state of one worker process
+struct PartitionWorker {
+    int id;
+    int numPartitions;
+    double d;
+    int numPages;
+    enum DanglingMode dangling;
+    const struct RankKernel *kernel;
+
+    // The socket to the coordinator, and to every other worker
+    int control;
+    int *peers;
+
+    // The own pages and their in-links: own page k is k, and ghost g is
+    // numOwned + g
+    struct Graph local;
+    int numOwned;
+    int numGhosts;
+
+    // The ghosts from partition q are ghostOffsets[q] to
+    // ghostOffsets[q + 1] - 1, holding the pages ghostPages[g]
+    int *ghostOffsets;
+    int *ghostPages;
+
+    // The own pages whose contributions partition q needs are
+    // sendPages[sendOffsets[q]] to sendPages[sendOffsets[q + 1] - 1]
+    int *sendOffsets;
+    int *sendPages;
+    double *sendValues;
+
+    int *danglingPages;
+    int numDangling;
+    double *weights;
+
+    double *pageranks;
+    double *newPageranks;
+    double *contributions;
+    double *newContributions;
+
+    // What the next exchange sends to and receives from every other worker
+    char **sendBuffers;
+    size_t *sendSizes;
+    char **recvBuffers;
+    size_t *recvSizes;
+    size_t *sent;
+    size_t *received;
+    struct pollfd *polls;
+    int *pollPeers;
+};
+
+// What a worker reports before every iteration
+struct WorkerReport {
+    double diff;
+    double dangling;
+};
+
+// The coordinator's answer: whether to carry on, and the total value of the
+// dangling pages
+struct WorkerCommand {
+    int carryOn;
+    double dangling;
+};
+
+static void partitionPages(struct Graph *graph, enum PartitionMode mode,
+    int numPartitions, struct Partitioning *parts);
+static int *localityOrder(struct Graph *graph);
+static void cutOrder(struct Graph *graph, const int *order,
+    int numPartitions, int *owner);
+static long long countCutEdges(struct Graph *graph, const int *owner);
+static void freePartitioning(struct Partitioning *parts);
+static void reserveSockets(int numPartitions);
+static void createSockets(int numPartitions, int *pair);
+static int coordinate(struct Graph *graph, struct RankOptions *options,
+    struct Partitioning *parts, int *controls, double *pageranks);
+static void runWorker(struct Graph *graph, struct RankOptions *options,
+    struct Partitioning *parts, const double *startValues, int id,
+    int control, int *peers);
+static void buildLocalGraph(struct PartitionWorker *worker,
+    struct Graph *graph, struct Partitioning *parts);
+static void requestGhosts(struct PartitionWorker *worker,
+    struct Partitioning *parts);
+static void sendContributions(struct PartitionWorker *worker);
+static void exchange(struct PartitionWorker *worker);
+static void setExchange(struct PartitionWorker *worker, int q, void *send,
+    size_t sendSize, void *recv, size_t recvSize);
+static void stopWorker(struct PartitionWorker *worker);
+static int readFully(int fd, void *buffer, size_t size);
+static int writeFully(int fd, const void *buffer, size_t size);
+static int compareKeys(const void *a, const void *b);
+static void *allocOrExit(size_t size);
+
+// Returns the name of the partitioner as used on the command line
+const char *partitionName(enum PartitionMode mode) {
+    switch (mode) {
+        case PARTITION_HASH:
+            return "hash";
+        case PARTITION_LOCALITY:
+            return "locality";
+        default:
+            return "range";
+    }
+}
+
+// Finds the partitioner with the given name
+// Returns 1 if there is one, 0 otherwise
+int parsePartitionName(const char *name, enum PartitionMode *mode) {
+    enum PartitionMode modes[] = {
+        PARTITION_RANGE, PARTITION_HASH, PARTITION_LOCALITY
+    };
+
+    for (int i = 0; i < (int)(sizeof(modes) / sizeof(modes[0])); i++) {
+        if (strcmp(name, partitionName(modes[i])) == 0) {
+            *mode = modes[i];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Calculates the PageRank of each page with one worker process per
+// partition
+// Stores the values in pageranks and returns the number of iterations
+int calculatePageRankPartitioned(
+    struct Graph *graph, struct RankOptions *options, double *pageranks
+) {
+    int numPages = graph->numPages;
+    int numPartitions = options->numPartitions;
+    if (numPartitions > numPages) {
+        numPartitions = numPages > 0 ? numPages : 1;
+    }
+
+    struct Partitioning parts;
+    partitionPages(graph, options->partitioner, numPartitions, &parts);
+    statsSet(STATS_CUT_EDGES, countCutEdges(graph, parts.owner));
+
+    double *startValues = allocOrExit((numPages + 1) * sizeof(double));
+    for (int i = 0; i < numPages; i++) {
+        startValues[i] = options->warmStart ? pageranks[i] : 1.0 / numPages;
+    }
+
+    // One socket pair to the coordinator per worker, and one between every
+    // two workers: links[p * numPartitions + q] is the end of p towards q
+    reserveSockets(numPartitions);
+    int *controls = allocOrExit(2 * numPartitions * sizeof(int));
+    int *links = allocOrExit(numPartitions * numPartitions * sizeof(int));
+    for (int p = 0; p < numPartitions; p++) {
+        links[p * numPartitions + p] = -1;
+        createSockets(numPartitions, &controls[2 * p]);
+
+        for (int q = p + 1; q < numPartitions; q++) {
+            int pair[2];
+            createSockets(numPartitions, pair);
+            links[p * numPartitions + q] = pair[0];
+            links[q * numPartitions + p] = pair[1];
+        }
+    }
+
+    // Whatever is buffered is written once, not once per process
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t *workers = allocOrExit(numPartitions * sizeof(pid_t));
+    for (int p = 0; p < numPartitions; p++) {
+        workers[p] = fork();
+        if (workers[p] < 0) {
+            fprintf(stderr, "error: cannot start worker process\n");
+            exit(EXIT_FAILURE);
+        }
+
+        if (workers[p] == 0) {
+            // Keeps only the sockets of this worker
+            for (int k = 0; k < numPartitions * numPartitions; k++) {
+                if (k / numPartitions != p && links[k] >= 0) {
+                    close(links[k]);
+                }
+            }
+            for (int q = 0; q < numPartitions; q++) {
+                close(controls[2 * q]);
+                if (q != p) {
+                    close(controls[2 * q + 1]);
+                }
+            }
+
+            runWorker(graph, options, &parts, startValues, p,
+                controls[2 * p + 1], &links[p * numPartitions]);
+        }
+    }
+
+    for (int k = 0; k < numPartitions * numPartitions; k++) {
+        if (links[k] >= 0) {
+            close(links[k]);
+        }
+    }
+    for (int p = 0; p < numPartitions; p++) {
+        close(controls[2 * p + 1]);
+    }
+
+    int iteration = coordinate(graph, options, &parts, controls, pageranks);
+
+    for (int p = 0; p < numPartitions; p++) {
+        close(controls[2 * p]);
+
+        int status;
+        if (waitpid(workers[p], &status, 0) < 0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "error: partition worker %d failed\n", p);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    free(workers);
+    free(links);
+    free(controls);
+    free(startValues);
+    freePartitioning(&parts);
+
+    return iteration;
+}
+
+// Splits the pages into partitions with the given partitioner
+static void partitionPages(
+    struct Graph *graph, enum PartitionMode mode, int numPartitions,
+    struct Partitioning *parts
+) {
+    int numPages = graph->numPages;
+    parts->numPartitions = numPartitions;
+    parts->owner = allocOrExit((numPages + 1) * sizeof(int));
+    parts->offsets = allocOrExit((numPartitions + 1) * sizeof(int));
+    parts->pages = allocOrExit((numPages + 1) * sizeof(int));
+    parts->localIndex = allocOrExit((numPages + 1) * sizeof(int));
+
+    if (mode == PARTITION_HASH) {
+        for (int i = 0; i < numPages; i++) {
+            uint64_t hash = (uint64_t)(i + 1) * 0x9e3779b97f4a7c15ull;
+            parts->owner[i] = (hash >> 32) % numPartitions;
+        }
+    } else if (mode == PARTITION_LOCALITY) {
+        int *order = localityOrder(graph);
+        cutOrder(graph, order, numPartitions, parts->owner);
+        free(order);
+    } else {
+        cutOrder(graph, NULL, numPartitions, parts->owner);
+    }
+
+    // Lists the pages of every partition in ascending order
+    for (int p = 0; p <= numPartitions; p++) {
+        parts->offsets[p] = 0;
+    }
+    for (int i = 0; i < numPages; i++) {
+        parts->offsets[parts->owner[i] + 1]++;
+    }
+    for (int p = 0; p < numPartitions; p++) {
+        parts->offsets[p + 1] += parts->offsets[p];
+    }
+
+    for (int i = 0; i < numPages; i++) {
+        int p = parts->owner[i];
+        int k = parts->offsets[p]++;
+        parts->pages[k] = i;
+    }
+    for (int p = numPartitions; p > 0; p--) {
+        parts->offsets[p] = parts->offsets[p - 1];
+    }
+    parts->offsets[0] = 0;
+
+    for (int p = 0; p < numPartitions; p++) {
+        for (int k = parts->offsets[p]; k < parts->offsets[p + 1]; k++) {
+            parts->localIndex[parts->pages[k]] = k - parts->offsets[p];
+        }
+    }
+}
+
+// Returns the pages in breadth-first order over the links, followed both
+// ways, starting from each page not reached yet in ascending order
+static int *localityOrder(struct Graph *graph) {
+    int numPages = graph->numPages;
+    graphBuildOutLinks(graph);
+
+    int *order = allocOrExit((numPages + 1) * sizeof(int));
+    unsigned char *seen = allocOrExit(numPages + 1);
+    memset(seen, 0, numPages + 1);
+
+    int size = 0;
+    for (int start = 0; start < numPages; start++) {
+        if (seen[start]) {
+            continue;
+        }
+
+        seen[start] = 1;
+        order[size++] = start;
+        for (int head = size - 1; head < size; head++) {
+            int j = order[head];
+            for (int k = graph->inOffsets[j]; k < graph->inOffsets[j + 1];
+                 k++) {
+                int i = graph->inLinks[k];
+                if (!seen[i]) {
+                    seen[i] = 1;
+                    order[size++] = i;
+                }
+            }
+            for (int k = graph->outOffsets[j]; k < graph->outOffsets[j + 1];
+                 k++) {
+                int i = graph->outLinks[k];
+                if (!seen[i]) {
+                    seen[i] = 1;
+                    order[size++] = i;
+                }
+            }
+        }
+    }
+
+    free(seen);
+    return order;
+}
+
+// Cuts the pages, taken in the given order (or in ascending order if order
+// is NULL), into numPartitions consecutive runs
+// Every page costs one unit plus one unit per in-link, as in splitPages of
+// rankSolver.c, so each run has about the same amount of work
+static void cutOrder(
+    struct Graph *graph, const int *order, int numPartitions, int *owner
+) {
+    int numPages = graph->numPages;
+    long long total = (long long)numPages + graph->numEdges;
+
+    long long cost = 0;
+    for (int k = 0; k < numPages; k++) {
+        int i = order != NULL ? order[k] : k;
+        owner[i] = cost * numPartitions / total;
+        cost += 1 + graph->inOffsets[i + 1] - graph->inOffsets[i];
+    }
+}
+
+// Returns the number of links between pages of different partitions
+static long long countCutEdges(struct Graph *graph, const int *owner) {
+    long long cut = 0;
+    for (int i = 0; i < graph->numPages; i++) {
+        for (int k = graph->inOffsets[i]; k < graph->inOffsets[i + 1]; k++) {
+            cut += owner[graph->inLinks[k]] != owner[i];
+        }
+    }
+
+    return cut;
+}
+
+// Frees the arrays of a partitioning
+static void freePartitioning(struct Partitioning *parts) {
+    free(parts->owner);
+    free(parts->offsets);
+    free(parts->pages);
+    free(parts->localIndex);
+}
+
+// Makes sure the coordinator may open the numPartitions * (numPartitions + 1)
+// sockets of the workers at once, raising its limit on open files up to the
+// hard limit if it has to
+// Exits if the hard limit is too low
+static void reserveSockets(int numPartitions) {
+    rlim_t needed = (rlim_t)numPartitions * (numPartitions + 1) +
+        RESERVED_FILES;
+
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur >= needed) {
+        return;
+    }
+
+    if (limit.rlim_max != RLIM_INFINITY && limit.rlim_max < needed) {
+        fprintf(stderr, "error: %d partitions need %llu open files, but at "
+            "most %llu may be open (see ulimit -Hn)\n", numPartitions,
+            (unsigned long long)needed, (unsigned long long)limit.rlim_max);
+        exit(EXIT_FAILURE);
+    }
+
+    limit.rlim_cur = needed;
+    if (setrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        fprintf(stderr, "error: %d partitions need %llu open files: %s\n",
+            numPartitions, (unsigned long long)needed, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Creates a connected pair of sockets
+// Exits if it cannot
+static void createSockets(int numPartitions, int *pair) {
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        fprintf(stderr, "error: cannot create the sockets of %d partitions: "
+            "%s\n", numPartitions, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Runs the coordinator: adds up the reports of the workers before every
+// iteration, decides whether to carry on, and finally collects the values
+// Returns the number of iterations
+static int coordinate(
+    struct Graph *graph, struct RankOptions *options,
+    struct Partitioning *parts, int *controls, double *pageranks
+) {
+    int numPartitions = parts->numPartitions;
+    int iteration = options->startIteration;
+    double diff = options->diffPR;
+
+    for (int round = 0; ; round++) {
+        double total = 0;
+        double dangling = 0;
+        for (int p = 0; p < numPartitions; p++) {
+            struct WorkerReport report;
+            if (!readFully(controls[2 * p], &report, sizeof(report))) {
+                fprintf(stderr, "error: partition worker %d stopped\n", p);
+                exit(EXIT_FAILURE);
+            }
+            total += report.diff;
+            dangling += report.dangling;
+        }
+
+        // The first reports come before any iteration
+        if (round > 0) {
+            diff = total;
+            statsIteration("partitioned", iteration, diff, graph->numEdges);
+        }
+
+        struct WorkerCommand command;
+        command.carryOn = iteration < options->maxIterations &&
+            diff >= options->diffPR;
+        command.dangling = dangling;
+        for (int p = 0; p < numPartitions; p++) {
+            if (!writeFully(controls[2 * p], &command, sizeof(command))) {
+                fprintf(stderr, "error: partition worker %d stopped\n", p);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if (!command.carryOn) {
+            break;
+        }
+        iteration++;
+    }
+
+    // Every worker then sends the values of its own pages, in order
+    double *values = allocOrExit((graph->numPages + 1) * sizeof(double));
+    for (int p = 0; p < numPartitions; p++) {
+        int first = parts->offsets[p];
+        int numOwned = parts->offsets[p + 1] - first;
+        if (!readFully(controls[2 * p], values,
+                numOwned * sizeof(double))) {
+            fprintf(stderr, "error: partition worker %d stopped\n", p);
+            exit(EXIT_FAILURE);
+        }
+
+        for (int k = 0; k < numOwned; k++) {
+            pageranks[parts->pages[first + k]] = values[k];
+        }
+    }
+    free(values);
+
+    return iteration;
+}
+
+// Runs one worker process until the coordinator stops it, then sends it
+// the values of its own pages and exits
+static void runWorker(
+    struct Graph *graph, struct RankOptions *options,
+    struct Partitioning *parts, const double *startValues, int id,
+    int control, int *peers
+) {
+    struct PartitionWorker worker;
+    int numPartitions = parts->numPartitions;
+    worker.id = id;
+    worker.numPartitions = numPartitions;
+    worker.d = options->d;
+    worker.numPages = graph->numPages;
+    worker.dangling = options->dangling;
+    worker.kernel = rankKernelSelect(options->kernel);
+    if (worker.kernel == NULL) {
+        worker.kernel = rankKernelSelect(KERNEL_SCALAR);
+    }
+    worker.control = control;
+    worker.peers = peers;
+
+    worker.sendBuffers = allocOrExit(numPartitions * sizeof(char *));
+    worker.sendSizes = allocOrExit(numPartitions * sizeof(size_t));
+    worker.recvBuffers = allocOrExit(numPartitions * sizeof(char *));
+    worker.recvSizes = allocOrExit(numPartitions * sizeof(size_t));
+    worker.sent = allocOrExit(numPartitions * sizeof(size_t));
+    worker.received = allocOrExit(numPartitions * sizeof(size_t));
+    worker.polls = allocOrExit(numPartitions * sizeof(struct pollfd));
+    worker.pollPeers = allocOrExit(numPartitions * sizeof(int));
+    for (int q = 0; q < numPartitions; q++) {
+        if (q != id) {
+            fcntl(peers[q], F_SETFL, fcntl(peers[q], F_GETFL) | O_NONBLOCK);
+        }
+    }
+
+    buildLocalGraph(&worker, graph, parts);
+    requestGhosts(&worker, parts);
+
+    // Copies out the starting values, weights and dangling pages of the own
+    // pages
+    int numOwned = worker.numOwned;
+    int first = parts->offsets[id];
+    size_t size = (numOwned + worker.numGhosts + 1) * sizeof(double);
+    worker.pageranks = allocOrExit(size);
+    worker.newPageranks = allocOrExit(size);
+    worker.contributions = allocOrExit(size);
+    worker.newContributions = allocOrExit(size);
+    worker.danglingPages = allocOrExit((numOwned + 1) * sizeof(int));
+    worker.numDangling = 0;
+    worker.weights = NULL;
+    if (options->dangling == DANGLING_PERSONALIZED) {
+        worker.weights = allocOrExit((numOwned + 1) * sizeof(double));
+    }
+
+    for (int k = 0; k < numOwned; k++) {
+        int i = parts->pages[first + k];
+        worker.pageranks[k] = startValues[i];
+        if (worker.weights != NULL) {
+            worker.weights[k] = options->personalization[i];
+        }
+        if (options->dangling != DANGLING_LEAK && graph->outdegree[i] == 0) {
+            worker.danglingPages[worker.numDangling++] = k;
+        }
+    }
+
+    double d = worker.d;
+    worker.kernel->finish(&worker.local, d, worker.pageranks,
+        worker.pageranks, worker.contributions, 0, numOwned);
+
+    double diff = 0;
+    while (1) {
+        struct WorkerReport report;
+        report.diff = diff;
+        report.dangling = 0;
+        for (int k = 0; k < worker.numDangling; k++) {
+            report.dangling += worker.pageranks[worker.danglingPages[k]];
+        }
+
+        struct WorkerCommand command;
+        if (!writeFully(control, &report, sizeof(report)) ||
+            !readFully(control, &command, sizeof(command))) {
+            stopWorker(&worker);
+        }
+
+        if (!command.carryOn) {
+            break;
+        }
+
+        // Spreads the dangling pages as spreadDangling of rankSolver.c does
+        double teleport = (1 - d) / worker.numPages;
+        double danglingShare = 0;
+        if (worker.dangling == DANGLING_UNIFORM) {
+            teleport += d * command.dangling / worker.numPages;
+        } else if (worker.dangling == DANGLING_PERSONALIZED) {
+            danglingShare = d * command.dangling;
+        }
+
+        sendContributions(&worker);
+
+        worker.kernel->gather(&worker.local, worker.contributions, teleport,
+            worker.newPageranks, 0, numOwned);
+        if (worker.weights != NULL) {
+            for (int k = 0; k < numOwned; k++) {
+                worker.newPageranks[k] += danglingShare * worker.weights[k];
+            }
+        }
+        diff = worker.kernel->finish(&worker.local, d, worker.pageranks,
+            worker.newPageranks, worker.newContributions, 0, numOwned);
+
+        double *temp = worker.pageranks;
+        worker.pageranks = worker.newPageranks;
+        worker.newPageranks = temp;
+
+        temp = worker.contributions;
+        worker.contributions = worker.newContributions;
+        worker.newContributions = temp;
+    }
+
+    if (!writeFully(control, worker.pageranks, numOwned * sizeof(double))) {
+        stopWorker(&worker);
+    }
+
+    // The worker is a copy of the coordinator, so it leaves without running
+    // the exit handlers of the coordinator
+    _exit(EXIT_SUCCESS);
+}
+
+// Builds the graph of the own pages of a worker, with their in-links
+// renumbered, and lists its ghosts in order of partition, then of page
+static void buildLocalGraph(
+    struct PartitionWorker *worker, struct Graph *graph,
+    struct Partitioning *parts
+) {
+    int id = worker->id;
+    int numPartitions = worker->numPartitions;
+    int first = parts->offsets[id];
+    int numOwned = parts->offsets[id + 1] - first;
+    const int *owner = parts->owner;
+
+    struct Graph *local = &worker->local;
+    local->numPages = numOwned;
+    local->outdegree = allocOrExit((numOwned + 1) * sizeof(int));
+    local->inOffsets = allocOrExit((numOwned + 1) * sizeof(int));
+    local->outOffsets = NULL;
+    local->outLinks = NULL;
+
+    local->inOffsets[0] = 0;
+    for (int k = 0; k < numOwned; k++) {
+        int i = parts->pages[first + k];
+        local->outdegree[k] = graph->outdegree[i];
+        local->inOffsets[k + 1] = local->inOffsets[k] +
+            graph->inOffsets[i + 1] - graph->inOffsets[i];
+    }
+    local->numEdges = local->inOffsets[numOwned];
+    local->inLinks = allocOrExit((local->numEdges + 1) * sizeof(int));
+
+    // A ghost is known by its partition and page, which also sort it
+    uint64_t *keys = allocOrExit((local->numEdges + 1) * sizeof(uint64_t));
+    int numKeys = 0;
+    int e = 0;
+    for (int k = 0; k < numOwned; k++) {
+        int i = parts->pages[first + k];
+        for (int l = graph->inOffsets[i]; l < graph->inOffsets[i + 1]; l++) {
+            int j = graph->inLinks[l];
+            if (owner[j] == id) {
+                local->inLinks[e] = parts->localIndex[j];
+            } else {
+                keys[numKeys++] = (uint64_t)owner[j] << 32 | (uint32_t)j;
+                local->inLinks[e] = -1;
+            }
+            e++;
+        }
+    }
+
+    qsort(keys, numKeys, sizeof(uint64_t), compareKeys);
+    int numGhosts = 0;
+    for (int k = 0; k < numKeys; k++) {
+        if (numGhosts == 0 || keys[k] != keys[numGhosts - 1]) {
+            keys[numGhosts++] = keys[k];
+        }
+    }
+
+    worker->numOwned = numOwned;
+    worker->numGhosts = numGhosts;
+    worker->ghostPages = allocOrExit((numGhosts + 1) * sizeof(int));
+    worker->ghostOffsets = allocOrExit((numPartitions + 1) * sizeof(int));
+    for (int q = 0; q <= numPartitions; q++) {
+        worker->ghostOffsets[q] = 0;
+    }
+    for (int g = 0; g < numGhosts; g++) {
+        worker->ghostPages[g] = (uint32_t)keys[g];
+        worker->ghostOffsets[(keys[g] >> 32) + 1]++;
+    }
+    for (int q = 0; q < numPartitions; q++) {
+        worker->ghostOffsets[q + 1] += worker->ghostOffsets[q];
+    }
+
+    // Points every in-link from another partition at its ghost
+    e = 0;
+    for (int k = 0; k < numOwned; k++) {
+        int i = parts->pages[first + k];
+        for (int l = graph->inOffsets[i]; l < graph->inOffsets[i + 1]; l++) {
+            int j = graph->inLinks[l];
+            if (local->inLinks[e] < 0) {
+                uint64_t key = (uint64_t)owner[j] << 32 | (uint32_t)j;
+                uint64_t *ghost = bsearch(&key, keys, numGhosts,
+                    sizeof(uint64_t), compareKeys);
+                local->inLinks[e] = numOwned + (ghost - keys);
+            }
+            e++;
+        }
+    }
+
+    free(keys);
+}
+
+// Tells every other worker which of its pages this worker has ghosts of,
+// and learns which own pages to send to each of them
+// The pages are asked for in ascending order, which is also the order the
+// ghosts of a partition are stored in
+static void requestGhosts(
+    struct PartitionWorker *worker, struct Partitioning *parts
+) {
+    int id = worker->id;
+    int numPartitions = worker->numPartitions;
+
+    int *asked = allocOrExit(numPartitions * sizeof(int));
+    int *counts = allocOrExit(numPartitions * sizeof(int));
+    for (int q = 0; q < numPartitions; q++) {
+        asked[q] = worker->ghostOffsets[q + 1] - worker->ghostOffsets[q];
+        counts[q] = 0;
+        if (q != id) {
+            setExchange(worker, q, &asked[q], sizeof(int), &counts[q],
+                sizeof(int));
+        }
+    }
+    exchange(worker);
+
+    worker->sendOffsets = allocOrExit((numPartitions + 1) * sizeof(int));
+    worker->sendOffsets[0] = 0;
+    for (int q = 0; q < numPartitions; q++) {
+        worker->sendOffsets[q + 1] = worker->sendOffsets[q] + counts[q];
+    }
+
+    int numSends = worker->sendOffsets[numPartitions];
+    worker->sendPages = allocOrExit((numSends + 1) * sizeof(int));
+    worker->sendValues = allocOrExit((numSends + 1) * sizeof(double));
+    for (int q = 0; q < numPartitions; q++) {
+        if (q != id) {
+            setExchange(worker, q,
+                worker->ghostPages + worker->ghostOffsets[q],
+                asked[q] * sizeof(int),
+                worker->sendPages + worker->sendOffsets[q],
+                counts[q] * sizeof(int));
+        }
+    }
+    exchange(worker);
+
+    // The pages asked for are own pages, numbered as such
+    for (int k = 0; k < numSends; k++) {
+        worker->sendPages[k] = parts->localIndex[worker->sendPages[k]];
+    }
+
+    free(asked);
+    free(counts);
+}
+
+// Sends the contributions other workers have ghosts of, and receives those
+// of the ghosts of this worker
+static void sendContributions(struct PartitionWorker *worker) {
+    int numPartitions = worker->numPartitions;
+    for (int k = 0; k < worker->sendOffsets[numPartitions]; k++) {
+        worker->sendValues[k] = worker->contributions[worker->sendPages[k]];
+    }
+
+    double *ghosts = worker->contributions + worker->numOwned;
+    for (int q = 0; q < numPartitions; q++) {
+        if (q == worker->id) {
+            continue;
+        }
+
+        int sendFirst = worker->sendOffsets[q];
+        int recvFirst = worker->ghostOffsets[q];
+        setExchange(worker, q, worker->sendValues + sendFirst,
+            (worker->sendOffsets[q + 1] - sendFirst) * sizeof(double),
+            ghosts + recvFirst,
+            (worker->ghostOffsets[q + 1] - recvFirst) * sizeof(double));
+    }
+    exchange(worker);
+}
+
+// Sends the buffers set by setExchange to every other worker and receives
+// theirs, all at the same time, waiting with poll for any socket that can
+// go on
+static void exchange(struct PartitionWorker *worker) {
+    int numPartitions = worker->numPartitions;
+    for (int q = 0; q < numPartitions; q++) {
+        worker->sent[q] = 0;
+        worker->received[q] = 0;
+    }
+
+    while (1) {
+        int numPolls = 0;
+        for (int q = 0; q < numPartitions; q++) {
+            if (q == worker->id) {
+                continue;
+            }
+
+            short events = 0;
+            if (worker->sent[q] < worker->sendSizes[q]) {
+                events |= POLLOUT;
+            }
+            if (worker->received[q] < worker->recvSizes[q]) {
+                events |= POLLIN;
+            }
+
+            if (events != 0) {
+                worker->polls[numPolls].fd = worker->peers[q];
+                worker->polls[numPolls].events = events;
+                worker->polls[numPolls].revents = 0;
+                worker->pollPeers[numPolls++] = q;
+            }
+        }
+
+        if (numPolls == 0) {
+            return;
+        }
+
+        if (poll(worker->polls, numPolls, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            stopWorker(worker);
+        }
+
+        for (int k = 0; k < numPolls; k++) {
+            int q = worker->pollPeers[k];
+            short revents = worker->polls[k].revents;
+            int fd = worker->peers[q];
+
+            if ((revents & (POLLOUT | POLLERR)) &&
+                worker->sent[q] < worker->sendSizes[q]) {
+                ssize_t n = send(fd, worker->sendBuffers[q] + worker->sent[q],
+                    worker->sendSizes[q] - worker->sent[q], MSG_NOSIGNAL);
+                if (n > 0) {
+                    worker->sent[q] += n;
+                } else if (errno != EAGAIN && errno != EINTR) {
+                    stopWorker(worker);
+                }
+            }
+
+            if ((revents & (POLLIN | POLLHUP | POLLERR)) &&
+                worker->received[q] < worker->recvSizes[q]) {
+                ssize_t n = recv(fd,
+                    worker->recvBuffers[q] + worker->received[q],
+                    worker->recvSizes[q] - worker->received[q], 0);
+                if (n > 0) {
+                    worker->received[q] += n;
+                } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                    stopWorker(worker);
+                }
+            }
+        }
+    }
+}
+
+// Sets what the next exchange sends to and receives from worker q
+static void setExchange(
+    struct PartitionWorker *worker, int q, void *send, size_t sendSize,
+    void *recv, size_t recvSize
+) {
+    worker->sendBuffers[q] = send;
+    worker->sendSizes[q] = sendSize;
+    worker->recvBuffers[q] = recv;
+    worker->recvSizes[q] = recvSize;
+}
+
+// Ends a worker that has lost a connection
+static void stopWorker(struct PartitionWorker *worker) {
+    fprintf(stderr, "error: partition worker %d lost a connection\n",
+        worker->id);
+    _exit(EXIT_FAILURE);
+}
+
+// Reads exactly size bytes from a socket
+// Returns 0 if the other side has gone
+static int readFully(int fd, void *buffer, size_t size) {
+    char *bytes = buffer;
+    while (size > 0) {
+        ssize_t n = recv(fd, bytes, size, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return 0;
+        }
+        bytes += n;
+        size -= n;
+    }
+
+    return 1;
+}
+
+// Writes exactly size bytes to a socket
+// Returns 0 if the other side has gone
+static int writeFully(int fd, const void *buffer, size_t size) {
+    const char *bytes = buffer;
+    while (size > 0) {
+        ssize_t n = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return 0;
+        }
+        bytes += n;
+        size -= n;
+    }
+
+    return 1;
+}
+
+// Compares two ghost keys for qsort and bsearch
+static int compareKeys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Allocates memory and exits if there is none left
+static void *allocOrExit(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
@@ -0,0 +1,50 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Partitioned PageRank Solver
+//
+// Description:
+// Runs the Jacobi iteration of rankSolver.h in several worker processes, one
+// per partition of the pages, so the work of every iteration is split
+// between them. The pages are split into numPartitions partitions by one of:
+//     PARTITION_RANGE     contiguous ranges of page IDs with about the same
+//                         number of pages plus in-links
+//     PARTITION_HASH      a hash of the page ID, which balances any graph
+//                         but cuts most links
+//     PARTITION_LOCALITY  ranges of a breadth-first order of the links, taken
+//                         both ways, so linked pages tend to share a
+//                         partition and fewer links cross partitions
+//
+// Each worker keeps only its own pages: their values, their in-links,
+// renumbered, and a "ghost" copy of the contribution of every page of
+// another partition that links to one of them. Before every iteration the
+// workers send each other only those boundary contributions, over a Unix
+// domain socket between every two workers. A coordinator, the calling
+// process, adds up the differences and dangling values the workers report
+// over a socket of their own, decides when to stop, and collects the final
+// values. The contributions of every page are added in the same order as by
+// SOLVER_JACOBI, so the values are the same, apart from the rounding of the
+// total of the dangling pages.
+//
+// This splits the CPU work, not the memory. The coordinator is given the
+// whole graph, already loaded, and the workers are forked from it, so every
+// worker runs on the same machine and the peak memory of a run is no lower
+// than with one process: only the rank vectors each worker updates, and the
+// in-links it reads, are limited to its own partition.
+//
+// While it starts the workers, the coordinator holds numPartitions *
+// (numPartitions + 1) sockets. It raises its limit on open files as far as
+// needed, and stops with an error if the hard limit (ulimit -Hn) is too low.
+//
+// The partitioned solver does not support checkpoints.
+
+#ifndef RANK_PARTITION_H
+#define RANK_PARTITION_H
+
+#include "graph.h"
+#include "rankSolver.h"
+
+const char *partitionName(enum PartitionMode mode);
+int parsePartitionName(const char *name, enum PartitionMode *mode);
+int calculatePageRankPartitioned(struct Graph *graph,
+    struct RankOptions *options, double *pageranks);
+
+#endif
@@ -0,0 +1,704 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// PageRank Solver
+//
+// Description:
+// Implements the solver declared in rankSolver.h. With more than one thread,
+// the threads are started once and meet at a barrier before and after every
+// iteration. The main thread works on the first range itself, adds up the
+// differences of all the ranges and decides whether to stop. Each page is
+// always updated by exactly the same sum, so the PageRank values do not depend
+// on the number of threads.
+//
+// The adaptive solver keeps a state for every page: the number of iterations
+// in a row in which its value moved by less than diffPR / (ADAPTIVE_SCALE *
+// numPages). After ADAPTIVE_STABLE_ITERATIONS such iterations it is marked
+// PAGE_FREEZING. In the next iteration its final value is copied into the
+// other vector and it becomes PAGE_FROZEN, after which it costs nothing. Only
+// the thread owning a page ever reads or writes its state. Frozen pages no
+// longer count towards the difference, so the adaptive values are slightly
+// less exact than the Jacobi ones (well within the 10^-4 tolerance).
+//
+// The push solver keeps a residual r for every page: how far its value is from
+// the right-hand side of the PageRank equation. Pushing a page adds its
+// residual to its value and passes d * r / outdegree on to each out-link. The
+// sum of the residuals is exactly the difference the next Jacobi iteration
+// would see, so pushing until every residual is below diffPR / numPages meets
+// the same convergence test. Pages with residual are kept in a FIFO queue, and
+// every time the pages queued at the start of a round have been pushed counts
+// as one iteration.
+//
+// The Jacobi solver keeps the contribution of every page to its out-links
+// next to its PageRank value, in a second pair of vectors swapped with the
+// values. Each thread calculates the contributions of its own range once its
+// new values are known, so the next iteration can start after the same
+// barrier as before.
+//
+// Before every iteration, the main thread adds up the values of the dangling
+// pages, always in the same order, and turns the total into the part every
+// page receives: an extra (d * total) / numPages in the teleport term, or
+// d * total times the weight of the page.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "rankSolver.h"
+#include "rankPartition.h"
+#include "stats.h"
+
+#define ADAPTIVE_SCALE 10
+#define ADAPTIVE_STABLE_ITERATIONS 3
+
+#define PAGE_ACTIVE 0
+#define PAGE_FREEZING ADAPTIVE_STABLE_ITERATIONS
+#define PAGE_FROZEN (ADAPTIVE_STABLE_ITERATIONS + 1)
+
+struct RankShared {
+    struct Graph *graph;
+    double d;
+    double *pageranks;
+    double *newPageranks;
+    const struct RankKernel *kernel;
+    double *contributions;
+    double *newContributions;
+    unsigned char *states;
+    double tolerance;
+    enum DanglingMode dangling;
+    const double *weights;
+    int *danglingPages;
+    int numDangling;
+    double teleport;
+    double danglingShare;
+    int done;
+    pthread_barrier_t start;
+    pthread_barrier_t end;
+};
+
+struct RankWorker {
+    struct RankShared *shared;
+    int first;
+    int last;
+    double diff;
+};
+
+static void splitPages(struct Graph *graph, struct RankWorker *workers,
+    int numThreads);
+static double updatePagerank(struct RankShared *shared, int first, int last);
+static double updatePagerankInPlace(struct RankShared *shared);
+static void findDanglingPages(struct RankShared *shared);
+static void spreadDangling(struct RankShared *shared);
+static int calculatePageRankPush(struct Graph *graph,
+    struct RankOptions *options, double *pageranks);
+static void saveCheckpoint(struct RankOptions *options,
+    const double *pageranks, int iteration);
+static void *runWorker(void *arg);
+static void *allocOrExit(size_t size);
+
+// Calculates the PageRank of each page
+// Stores the values in pageranks and returns the number of iterations
+int calculatePageRank(
+    struct Graph *graph, struct RankOptions *options, double *pageranks
+) {
+    int numPages = graph->numPages;
+    if (options->solver == SOLVER_JACOBI && options->numPartitions > 1 &&
+        numPages > 1) {
+        return calculatePageRankPartitioned(graph, options, pageranks);
+    }
+
+    int numThreads = options->numThreads;
+    if (numThreads > numPages) {
+        numThreads = numPages > 0 ? numPages : 1;
+    }
+
+    struct RankShared shared;
+    shared.graph = graph;
+    shared.d = options->d;
+    shared.pageranks = allocOrExit((numPages + 1) * sizeof(double));
+    shared.newPageranks = allocOrExit((numPages + 1) * sizeof(double));
+    shared.kernel = NULL;
+    shared.contributions = NULL;
+    shared.newContributions = NULL;
+    shared.states = NULL;
+    shared.tolerance = 0;
+    shared.done = 0;
+    shared.dangling = options->dangling;
+    shared.weights = options->dangling == DANGLING_PERSONALIZED ? 
+        options->personalization : NULL;
+    shared.danglingPages = NULL;
+    shared.numDangling = 0;
+    shared.teleport = (1 - options->d) / numPages;
+    shared.danglingShare = 0;
+    findDanglingPages(&shared);
+
+    if (options->solver == SOLVER_ADAPTIVE) {
+        shared.states = allocOrExit(numPages + 1);
+        memset(shared.states, PAGE_ACTIVE, numPages + 1);
+        shared.tolerance = options->diffPR / (ADAPTIVE_SCALE * numPages);
+    }
+
+    // Gauss-Seidel updates the values in order, so it runs on one thread
+    if (options->solver == SOLVER_GAUSS_SEIDEL) {
+        numThreads = 1;
+    }
+
+    // Initialize PageRank values
+    for (int i = 0; i < numPages; i++) {
+        shared.pageranks[i] = options->warmStart ? pageranks[i] : 
+            1.0 / numPages;
+    }
+
+    if (options->solver == SOLVER_PUSH) {
+        int iteration = calculatePageRankPush(graph, options, 
+            shared.pageranks);
+        for (int i = 0; i < numPages; i++) {
+            pageranks[i] = shared.pageranks[i];
+        }
+
+        free(shared.pageranks);
+        free(shared.newPageranks);
+        free(shared.danglingPages);
+        return iteration;
+    }
+
+    // Calculates the contributions of the starting values
+    if (options->solver == SOLVER_JACOBI) {
+        shared.kernel = rankKernelSelect(options->kernel);
+        if (shared.kernel == NULL) {
+            shared.kernel = rankKernelSelect(KERNEL_SCALAR);
+        }
+
+        shared.contributions = allocOrExit((numPages + 1) * sizeof(double));
+        shared.newContributions = 
+            allocOrExit((numPages + 1) * sizeof(double));
+        shared.kernel->finish(graph, shared.d, shared.pageranks, 
+            shared.pageranks, shared.contributions, 0, numPages);
+    }
+
+    struct RankWorker *workers =
+        allocOrExit(numThreads * sizeof(struct RankWorker));
+    pthread_t *threads = allocOrExit(numThreads * sizeof(pthread_t));
+    splitPages(graph, workers, numThreads);
+
+    // Starts the other threads, the main thread works on the first range
+    if (numThreads > 1) {
+        pthread_barrier_init(&shared.start, NULL, numThreads);
+        pthread_barrier_init(&shared.end, NULL, numThreads);
+        for (int t = 1; t < numThreads; t++) {
+            workers[t].shared = &shared;
+            if (pthread_create(&threads[t], NULL, runWorker, &workers[t])) {
+                fprintf(stderr, "error: cannot create thread\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    int iteration = options->startIteration;
+    double diff = options->diffPR;
+
+    // Iteratively updates the PageRank values
+    while (iteration < options->maxIterations && diff >= options->diffPR) {
+        spreadDangling(&shared);
+
+        if (options->solver == SOLVER_GAUSS_SEIDEL) {
+            // Updates the values in place
+            // Nothing needs to be swapped afterwards
+            diff = updatePagerankInPlace(&shared);
+        } else {
+            if (numThreads > 1) {
+                pthread_barrier_wait(&shared.start);
+            }
+
+            // Calculate the difference between new and old PageRank values
+            diff = updatePagerank(&shared, workers[0].first, workers[0].last);
+
+            if (numThreads > 1) {
+                pthread_barrier_wait(&shared.end);
+                for (int t = 1; t < numThreads; t++) {
+                    diff += workers[t].diff;
+                }
+            }
+
+            // Updates the PageRank value for the next iteration
+            double *temp = shared.pageranks;
+            shared.pageranks = shared.newPageranks;
+            shared.newPageranks = temp;
+
+            temp = shared.contributions;
+            shared.contributions = shared.newContributions;
+            shared.newContributions = temp;
+        }
+
+        iteration++;
+        saveCheckpoint(options, shared.pageranks, iteration);
+        statsIteration(solverName(options->solver), iteration, diff,
+            graph->numEdges);
+    }
+
+    // Lets the other threads leave and waits for them
+    if (numThreads > 1) {
+        shared.done = 1;
+        pthread_barrier_wait(&shared.start);
+        for (int t = 1; t < numThreads; t++) {
+            pthread_join(threads[t], NULL);
+        }
+
+        pthread_barrier_destroy(&shared.start);
+        pthread_barrier_destroy(&shared.end);
+    }
+
+    for (int i = 0; i < numPages; i++) {
+        pageranks[i] = shared.pageranks[i];
+    }
+
+    free(shared.pageranks);
+    free(shared.newPageranks);
+    free(shared.contributions);
+    free(shared.newContributions);
+    free(shared.states);
+    free(shared.danglingPages);
+    free(workers);
+    free(threads);
+
+    return iteration;
+}
+
+// Calculates numVectors PageRank vectors at once
+// teleports and ranks hold numVectors values for every page: those of page i
+// are at i * numVectors to i * numVectors + numVectors - 1
+// The teleport weights of each vector must add up to 1
+// Stores the values in ranks and returns the number of iterations
+int calculatePageRankBatch(
+    struct Graph *graph, struct RankOptions *options, int numVectors,
+    const double *teleports, double *ranks
+) {
+    int numPages = graph->numPages;
+    int k = numVectors;
+    double d = options->d;
+    size_t size = ((size_t)numPages * k + 1) * sizeof(double);
+
+    double *values = allocOrExit(size);
+    double *newValues = allocOrExit(size);
+    double *contributions = allocOrExit(size);
+    double *dangling = allocOrExit(k * sizeof(double));
+    double *diffs = allocOrExit(k * sizeof(double));
+
+    for (size_t i = 0; i < (size_t)numPages * k; i++) {
+        values[i] = 1.0 / numPages;
+    }
+
+    int iteration = 0;
+    double diff = options->diffPR;
+    while (iteration < options->maxIterations && diff >= options->diffPR) {
+        // Calculates the contributions of every page to all the vectors,
+        // and adds up the values of the dangling pages
+        for (int t = 0; t < k; t++) {
+            dangling[t] = 0;
+            diffs[t] = 0;
+        }
+
+        for (int j = 0; j < numPages; j++) {
+            double *value = &values[(size_t)j * k];
+            double *contribution = &contributions[(size_t)j * k];
+            for (int t = 0; t < k; t++) {
+                if (graph->outdegree[j] == 0) {
+                    dangling[t] += value[t];
+                    contribution[t] = 0;
+                } else {
+                    contribution[t] = d * value[t] / graph->outdegree[j];
+                }
+            }
+        }
+
+        for (int i = 0; i < numPages; i++) {
+            const double *teleport = &teleports[(size_t)i * k];
+            double *newValue = &newValues[(size_t)i * k];
+            for (int t = 0; t < k; t++) {
+                newValue[t] = (1 - d) * teleport[t];
+                if (options->dangling == DANGLING_UNIFORM) {
+                    newValue[t] += d * dangling[t] / numPages;
+                } else if (options->dangling == DANGLING_PERSONALIZED) {
+                    newValue[t] += d * dangling[t] * teleport[t];
+                }
+            }
+
+            for (int e = graph->inOffsets[i]; e < graph->inOffsets[i + 1];
+                e++) {
+                const double *contribution = 
+                    &contributions[(size_t)graph->inLinks[e] * k];
+                for (int t = 0; t < k; t++) {
+                    newValue[t] += contribution[t];
+                }
+            }
+
+            const double *value = &values[(size_t)i * k];
+            for (int t = 0; t < k; t++) {
+                diffs[t] += fabs(newValue[t] - value[t]);
+            }
+        }
+
+        double *temp = values;
+        values = newValues;
+        newValues = temp;
+
+        // Goes on until the vector furthest from converging has converged
+        diff = 0;
+        for (int t = 0; t < k; t++) {
+            if (diffs[t] > diff) {
+                diff = diffs[t];
+            }
+        }
+
+        iteration++;
+
+        // Every edge is followed once for each vector
+        statsIteration("batch", iteration, diff,
+            (long long)graph->numEdges * k);
+    }
+
+    memcpy(ranks, values, (size_t)numPages * k * sizeof(double));
+
+    free(values);
+    free(newValues);
+    free(contributions);
+    free(dangling);
+    free(diffs);
+
+    return iteration;
+}
+
+// Returns the name of the solver as used on the command line
+const char *solverName(enum SolverMode solver) {
+    switch (solver) {
+        case SOLVER_GAUSS_SEIDEL:
+            return "gauss-seidel";
+        case SOLVER_ADAPTIVE:
+            return "adaptive";
+        case SOLVER_PUSH:
+            return "push";
+        default:
+            return "jacobi";
+    }
+}
+
+// Finds the solver with the given name
+// Returns 1 if there is one, 0 otherwise
+int parseSolverName(const char *name, enum SolverMode *solver) {
+    enum SolverMode modes[] = {
+        SOLVER_JACOBI, SOLVER_GAUSS_SEIDEL, SOLVER_ADAPTIVE, SOLVER_PUSH
+    };
+
+    for (int i = 0; i < (int)(sizeof(modes) / sizeof(modes[0])); i++) {
+        if (strcmp(name, solverName(modes[i])) == 0) {
+            *solver = modes[i];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Returns the name of the dangling mode as used on the command line
+const char *danglingName(enum DanglingMode dangling) {
+    switch (dangling) {
+        case DANGLING_UNIFORM:
+            return "uniform";
+        case DANGLING_PERSONALIZED:
+            return "personalized";
+        default:
+            return "leak";
+    }
+}
+
+// Finds the dangling mode with the given name
+// Returns 1 if there is one, 0 otherwise
+int parseDanglingName(const char *name, enum DanglingMode *dangling) {
+    enum DanglingMode modes[] = {
+        DANGLING_LEAK, DANGLING_UNIFORM, DANGLING_PERSONALIZED
+    };
+
+    for (int i = 0; i < (int)(sizeof(modes) / sizeof(modes[0])); i++) {
+        if (strcmp(name, danglingName(modes[i])) == 0) {
+            *dangling = modes[i];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Splits the pages into one contiguous range per thread
+// Every page costs one unit plus one unit per in-link, so that each range
+// has about the same amount of work
+static void splitPages(
+    struct Graph *graph, struct RankWorker *workers, int numThreads
+) {
+    int numPages = graph->numPages;
+    long total = (long)numPages + graph->numEdges;
+
+    int first = 0;
+    for (int t = 0; t < numThreads; t++) {
+        long target = total * (t + 1) / numThreads;
+
+        // Binary search for the first page whose cost starts after the target
+        int lo = first;
+        int hi = numPages;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if ((long)mid + graph->inOffsets[mid] < target) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        workers[t].first = first;
+        workers[t].last = t == numThreads - 1 ? numPages : lo;
+        workers[t].diff = 0;
+        first = workers[t].last;
+    }
+}
+
+// Helper function to update the PageRank values of pages first to last - 1
+// Only the in-links of each page are visited
+// Returns the sum of the differences between new and old PageRank values
+static double updatePagerank(struct RankShared *shared, int first, int last) {
+    struct Graph *graph = shared->graph;
+    double d = shared->d;
+    double *pageranks = shared->pageranks;
+    double *newPageranks = shared->newPageranks;
+    unsigned char *states = shared->states;
+    double diff = 0;
+
+    // The Jacobi solver sums the contributions of the in-links
+    if (shared->kernel != NULL) {
+        shared->kernel->gather(graph, shared->contributions, shared->teleport,
+            newPageranks, first, last);
+        if (shared->weights != NULL) {
+            for (int i = first; i < last; i++) {
+                newPageranks[i] += shared->danglingShare * shared->weights[i];
+            }
+        }
+        return shared->kernel->finish(graph, d, pageranks, newPageranks, 
+            shared->newContributions, first, last);
+    }
+
+    for (int i = first; i < last; i++) {
+        // Frozen pages keep their value in both vectors
+        if (states != NULL && states[i] >= PAGE_FREEZING) {
+            if (states[i] == PAGE_FREEZING) {
+                newPageranks[i] = pageranks[i];
+                states[i] = PAGE_FROZEN;
+            }
+            continue;
+        }
+
+        newPageranks[i] = shared->teleport;
+
+        for (int k = graph->inOffsets[i]; k < graph->inOffsets[i + 1]; k++) {
+            int j = graph->inLinks[k];
+            newPageranks[i] += d * pageranks[j] / graph->outdegree[j];
+        }
+
+        if (shared->weights != NULL) {
+            newPageranks[i] += shared->danglingShare * shared->weights[i];
+        }
+
+        double change = fabs(newPageranks[i] - pageranks[i]);
+        if (states != NULL) {
+            // Counts the iterations in a row in which the page was stable
+            states[i] = change < shared->tolerance ? states[i] + 1 : 0;
+        }
+
+        diff += change;
+    }
+
+    return diff;
+}
+
+// Helper function to update the PageRank values in place (Gauss-Seidel)
+// Pages later in the order already see the new values of earlier pages
+// Returns the sum of the differences between new and old PageRank values
+// The dangling pages are added up once, before the pass
+static double updatePagerankInPlace(struct RankShared *shared) {
+    struct Graph *graph = shared->graph;
+    int numPages = graph->numPages;
+    double d = shared->d;
+    double *pageranks = shared->pageranks;
+    double diff = 0;
+
+    for (int i = 0; i < numPages; i++) {
+        double newPagerank = shared->teleport;
+
+        for (int k = graph->inOffsets[i]; k < graph->inOffsets[i + 1]; k++) {
+            int j = graph->inLinks[k];
+            newPagerank += d * pageranks[j] / graph->outdegree[j];
+        }
+
+        if (shared->weights != NULL) {
+            newPagerank += shared->danglingShare * shared->weights[i];
+        }
+
+        diff += fabs(newPagerank - pageranks[i]);
+        pageranks[i] = newPagerank;
+    }
+
+    return diff;
+}
+
+// Lists the pages without out-links, unless their value is left to leak
+static void findDanglingPages(struct RankShared *shared) {
+    struct Graph *graph = shared->graph;
+    if (shared->dangling == DANGLING_LEAK) {
+        return;
+    }
+
+    shared->danglingPages = allocOrExit((graph->numPages + 1) * sizeof(int));
+    for (int i = 0; i < graph->numPages; i++) {
+        if (graph->outdegree[i] == 0) {
+            shared->danglingPages[shared->numDangling++] = i;
+        }
+    }
+}
+
+// Adds up the current values of the dangling pages, and sets the part of
+// the total each page receives in the next iteration
+static void spreadDangling(struct RankShared *shared) {
+    if (shared->dangling == DANGLING_LEAK) {
+        return;
+    }
+
+    double total = 0;
+    for (int k = 0; k < shared->numDangling; k++) {
+        total += shared->pageranks[shared->danglingPages[k]];
+    }
+
+    int numPages = shared->graph->numPages;
+    double d = shared->d;
+    if (shared->dangling == DANGLING_UNIFORM) {
+        shared->teleport = (1 - d) / numPages + d * total / numPages;
+    } else {
+        shared->danglingShare = d * total;
+    }
+}
+
+// Calculates the PageRank values by pushing residuals (see above)
+// pageranks holds the starting values and receives the result
+// Returns the number of rounds
+static int calculatePageRankPush(
+    struct Graph *graph, struct RankOptions *options, double *pageranks
+) {
+    int numPages = graph->numPages;
+    double d = options->d;
+    double tolerance = options->diffPR / numPages;
+
+    graphBuildOutLinks(graph);
+
+    double *residuals = allocOrExit((numPages + 1) * sizeof(double));
+    int *queue = allocOrExit((numPages + 1) * sizeof(int));
+    unsigned char *queued = allocOrExit(numPages + 1);
+    int head = 0;
+    int size = 0;
+
+    // Calculates the residual of every page with one pass over the in-links
+    for (int i = 0; i < numPages; i++) {
+        double target = (1 - d) / numPages;
+        for (int k = graph->inOffsets[i]; k < graph->inOffsets[i + 1]; k++) {
+            int j = graph->inLinks[k];
+            target += d * pageranks[j] / graph->outdegree[j];
+        }
+
+        residuals[i] = target - pageranks[i];
+        queued[i] = fabs(residuals[i]) >= tolerance;
+        if (queued[i]) {
+            queue[size++] = i;
+        }
+    }
+
+    int iteration = options->startIteration;
+    while (size > 0 && iteration < options->maxIterations) {
+        // Pushes every page that was queued when the round started
+        // The residuals pushed add up to the difference of the round
+        double pushed = 0;
+        long long edges = 0;
+        for (int roundSize = size; roundSize > 0; roundSize--) {
+            int j = queue[head];
+            head = (head + 1) % numPages;
+            size--;
+            queued[j] = 0;
+
+            double residual = residuals[j];
+            pageranks[j] += residual;
+            residuals[j] = 0;
+            pushed += fabs(residual);
+
+            if (graph->outdegree[j] == 0) {
+                continue;
+            }
+
+            double share = d * residual / graph->outdegree[j];
+            edges += graph->outdegree[j];
+            for (int k = graph->outOffsets[j]; k < graph->outOffsets[j + 1];
+                k++) {
+                int i = graph->outLinks[k];
+                residuals[i] += share;
+                if (!queued[i] && fabs(residuals[i]) >= tolerance) {
+                    queued[i] = 1;
+                    queue[(head + size) % numPages] = i;
+                    size++;
+                }
+            }
+        }
+
+        iteration++;
+        saveCheckpoint(options, pageranks, iteration);
+        statsIteration("push", iteration, pushed, edges);
+    }
+
+    free(residuals);
+    free(queue);
+    free(queued);
+
+    return iteration;
+}
+
+// Passes the current values to the checkpoint function, if one is due
+static void saveCheckpoint(
+    struct RankOptions *options, const double *pageranks, int iteration
+) {
+    if (options->checkpoint != NULL && options->checkpointEvery > 0 &&
+        iteration % options->checkpointEvery == 0) {
+        options->checkpoint(options->checkpointContext, pageranks, iteration);
+    }
+}
+
+// Runs the iterations of one of the other threads
+static void *runWorker(void *arg) {
+    struct RankWorker *worker = arg;
+    struct RankShared *shared = worker->shared;
+
+    while (1) {
+        pthread_barrier_wait(&shared->start);
+        if (shared->done) {
+            break;
+        }
+
+        worker->diff = updatePagerank(shared, worker->first, worker->last);
+
+        pthread_barrier_wait(&shared->end);
+    }
+
+    return NULL;
+}
+
+// Allocates memory and exits if there is none left
+static void *allocOrExit(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
@@ -0,0 +1,117 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// PageRank Solver
+//
+// Description:
+// Calculates the PageRank values of every page in a graph (see graph.h) by
+// power iteration. The pages can be split between several threads: each
+// thread owns a contiguous range of destination pages with roughly the same
+// number of in-links, and computes their new PageRank values and its part of
+// the sum of PageRank differences.
+//
+// Four solvers are available:
+//     SOLVER_JACOBI        the new values of an iteration are calculated from
+//                          the values of the previous iteration only
+//     SOLVER_GAUSS_SEIDEL  the values are updated in place, so every page sees
+//                          the values already updated in the same iteration
+//                          (single thread only)
+//     SOLVER_ADAPTIVE      like SOLVER_JACOBI, but a page whose value has
+//                          stopped moving is frozen and not calculated again
+//     SOLVER_PUSH          computes the residual of the starting values once,
+//                          then pushes residual along the out-links only from
+//                          the pages that still have some (single thread only)
+//
+// The solvers normally start from 1 / numPages for every page. With warmStart
+// set, they start from the values already in the pageranks array instead, for
+// example the PageRank values of a previous run. Starting SOLVER_PUSH from the
+// previous values of a collection in which only a few pages have changed only
+// does work around the changed pages.
+//
+// A page without out-links (a dangling page) passes its PageRank value on to
+// no page. What happens to that value is chosen by dangling:
+//     DANGLING_LEAK          it is lost, so the values add up to less than 1
+//     DANGLING_UNIFORM       it is spread evenly over all pages, as if the
+//                            page linked to every page
+//     DANGLING_PERSONALIZED  it is spread in proportion to personalization,
+//                            numPages weights adding up to 1
+// The total value of the dangling pages is calculated once per iteration, so
+// spreading it costs O(numPages) rather than a link to every page. The push
+// solver only supports DANGLING_LEAK.
+//
+// A long run can save its progress: if checkpoint is not NULL, it is called
+// with the current values after every checkpointEvery iterations. A run
+// started again from those values with startIteration set to the number of
+// iterations already done carries on where it stopped; Jacobi and
+// Gauss-Seidel keep no other state, so they give exactly the same values as a
+// run that never stopped.
+//
+// calculatePageRankBatch calculates several PageRank vectors in one pass over
+// the links per iteration, for example one per topic. Each vector has its own
+// teleport weights: the (1 - d) part of its value is given to page i in
+// proportion to the weight of page i instead of evenly, and with
+// DANGLING_PERSONALIZED so is the value of its dangling pages. The values of
+// the vectors are stored next to each other for every page, so the
+// contributions of an in-link to all the vectors are read together. The batch
+// always uses Jacobi iteration on one thread, and stops once every vector has
+// converged.
+//
+// SOLVER_JACOBI runs its inner loops through the kernel chosen by kernel (see
+// rankKernel.h), by default the fastest one the CPU supports. With
+// numPartitions above 1 it runs in that many worker processes instead, each
+// owning the pages of one partition chosen by partitioner (see
+// rankPartition.h).
+
+#ifndef RANK_SOLVER_H
+#define RANK_SOLVER_H
+
+#include "graph.h"
+#include "rankKernel.h"
+
+enum DanglingMode {
+    DANGLING_LEAK,
+    DANGLING_UNIFORM,
+    DANGLING_PERSONALIZED
+};
+
+enum PartitionMode {
+    PARTITION_RANGE,
+    PARTITION_HASH,
+    PARTITION_LOCALITY
+};
+
+enum SolverMode {
+    SOLVER_JACOBI,
+    SOLVER_GAUSS_SEIDEL,
+    SOLVER_ADAPTIVE,
+    SOLVER_PUSH
+};
+
+struct RankOptions {
+    double d;
+    double diffPR;
+    int maxIterations;
+    int numThreads;
+    enum SolverMode solver;
+    int warmStart;
+    enum KernelMode kernel;
+    enum DanglingMode dangling;
+    const double *personalization;
+    int numPartitions;
+    enum PartitionMode partitioner;
+
+    int startIteration;
+    int checkpointEvery;
+    void (*checkpoint)(void *context, const double *pageranks, 
+        int iteration);
+    void *checkpointContext;
+};
+
+const char *solverName(enum SolverMode solver);
+int parseSolverName(const char *name, enum SolverMode *solver);
+const char *danglingName(enum DanglingMode dangling);
+int parseDanglingName(const char *name, enum DanglingMode *dangling);
+int calculatePageRank(struct Graph *graph, struct RankOptions *options,
+    double *pageranks);
+int calculatePageRankBatch(struct Graph *graph, struct RankOptions *options,
+    int numVectors, const double *teleports, double *ranks);
+
+#endif
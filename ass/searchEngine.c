@@ -0,0 +1,635 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Search Engine
+//
+// Description:
+// Implements the search engine declared in searchEngine.h. Only the top
+// thirty results are displayed, in descending order of count (or PageRank,
+// if the count is equal, or alphabetically by URL if both are equal).
+//
+// When the engine is loaded, the pages are numbered in impact order, the
+// order of PageRank and URL, and every posting list is stored in that order.
+// A query then walks its posting lists together, one page at a time, from
+// the best page down. A page found later can only beat one found earlier by
+// having a higher count, so once thirty results have a count of at least c,
+// only pages in more than c of the lists are still worth finding. Such a
+// page must be in one of the shortest lists, since it cannot be in only the
+// c longest: the next page is taken from the heads of those shortest lists,
+// and looked for in the longest ones by galloping (doubling steps, then a
+// binary search), which skips whole blocks of the compressed lists without
+// decoding them. The query stops once no page can enter the top thirty,
+// which for a single common word is after thirty pages, whatever the length
+// of its list. The results found are selected with a heap of thirty, so the
+// other matching URLs are never sorted.
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "searchEngine.h"
+#include "rankList.h"
+#include "rankFile.h"
+#include "stats.h"
+
+static struct IndexFile *openBinaryIndex(int ownRanks);
+static double *readPagerankList(const char *filename,
+    struct InternTable *urls);
+static double *readRankFile(const char *filename, struct InternTable *urls);
+static double *matchRanks(const char *filename, struct IndexFile *index);
+static uint32_t *readInvertedIndex(char *filename,
+    struct SearchEngine *engine);
+static void buildImpactOrder(struct SearchEngine *engine,
+    const uint32_t *postings);
+static void countIndex(struct SearchEngine *engine);
+static int compareImpact(const void *a, const void *b);
+static int compareIds(const void *a, const void *b);
+static int findPostingLists(struct SearchEngine *engine,
+    struct SearchQuery *query, int numTerms, char **terms);
+static uint32_t nextPosition(struct PostingCursor *lists, int numLists);
+static int countPosition(struct PostingCursor *lists, int numLists,
+    uint32_t position);
+static int findTerm(struct SearchEngine *engine, const char *term);
+static const char *pageUrl(struct SearchEngine *engine, int page);
+static void addResult(struct SearchEngine *engine, struct SearchQuery *query,
+    uint32_t position, int count);
+static int selectTopResults(struct SearchIndex *results, int numResults,
+    int k);
+static void siftDown(struct SearchIndex *heap, int size, int i);
+static int compareResults(struct SearchIndex *a, struct SearchIndex *b);
+static void *reallocOrExit(void *ptr, size_t size);
+
+// Loads the binary index written by invertedIndex, if it is up to date
+// Otherwise reads the text files
+// If rankFilename is not NULL, the PageRank values are read from that binary
+// rank file instead of pagerankList.txt or the binary index
+struct SearchEngine *searchEngineLoad(const char *rankFilename) {
+    struct SearchEngine *engine = reallocOrExit(NULL,
+        sizeof(struct SearchEngine));
+    memset(engine, 0, sizeof(struct SearchEngine));
+
+    engine->index = openBinaryIndex(rankFilename != NULL);
+    if (engine->index != NULL) {
+        engine->numPages = engine->index->numPages;
+        engine->pageranks = engine->index->pageranks;
+        if (rankFilename != NULL) {
+            engine->textPageranks = matchRanks(rankFilename, engine->index);
+            engine->pageranks = engine->textPageranks;
+        }
+
+        // The pages are numbered in impact order already, unless they have
+        // other PageRank values
+        engine->postings = engine->index->postings;
+        if (!(engine->index->header->flags & INDEX_RANK_ORDER) ||
+            rankFilename != NULL) {
+            const uint64_t *offsets = engine->postings.postingOffsets;
+            uint32_t *postings = reallocOrExit(NULL,
+                (offsets[engine->postings.numTerms] + 1) * sizeof(uint32_t));
+            postingsDecode(&engine->postings, postings);
+            buildImpactOrder(engine, postings);
+            free(postings);
+        }
+        countIndex(engine);
+        return engine;
+    }
+
+    // Opens and scans the txt file to store the PageRank values
+    // Also gives every URL an ID in the URL table
+    engine->urls = internTableNew();
+    engine->textPageranks = rankFilename != NULL ?
+        readRankFile(rankFilename, engine->urls) :
+        readPagerankList(RANK_LIST_FILE_NAME, engine->urls);
+    engine->numPages = internTableSize(engine->urls);
+    engine->pageranks = engine->textPageranks;
+
+    uint32_t *postings = readInvertedIndex("invertedIndex.txt", engine);
+    engine->postings.numTerms = internTableSize(engine->terms);
+    engine->postings.postingOffsets = engine->postingOffsets;
+    buildImpactOrder(engine, postings);
+    free(postings);
+    countIndex(engine);
+
+    return engine;
+}
+
+// Frees the memory allocated to the engine, and unmaps the binary index
+void searchEngineFree(struct SearchEngine *engine) {
+    indexFileClose(engine->index);
+    internTableFree(engine->urls);
+    internTableFree(engine->terms);
+    free(engine->textPageranks);
+    free(engine->postingOffsets);
+    free(engine->pageAt);
+    postingsFree(&engine->encoded);
+    free(engine);
+}
+
+// Creates the working space for queries on the engine, with no URL in the
+// results yet
+struct SearchQuery *searchQueryNew(struct SearchEngine *engine) {
+    struct SearchQuery *query = reallocOrExit(NULL,
+        sizeof(struct SearchQuery));
+
+    // Every URL can appear in the results at most once
+    query->results = reallocOrExit(NULL,
+        (engine->numPages + 1) * sizeof(struct SearchIndex));
+    query->numResults = 0;
+
+    query->lists = NULL;
+    query->atLeast = NULL;
+    query->listCapacity = 0;
+
+    return query;
+}
+
+// Frees the working space of a query
+void searchQueryFree(struct SearchQuery *query) {
+    if (query != NULL) {
+        free(query->results);
+        free(query->lists);
+        free(query->atLeast);
+        free(query);
+    }
+}
+
+// Stores the URLs that may be among the top results in the results, then
+// moves the top results, sorted, to the front of query->results
+// Returns the number of top results
+int searchEngineQuery(
+    struct SearchEngine *engine, struct SearchQuery *query,
+    int numTerms, char **terms
+) {
+    statsAdd(STATS_QUERIES, 1);
+    query->numResults = 0;
+    int numLists = findPostingLists(engine, query, numTerms, terms);
+    if (numLists == 0) {
+        return 0;
+    }
+
+    for (int c = 0; c <= numLists; c++) {
+        query->atLeast[c] = 0;
+    }
+
+    // Only a page in more than threshold lists can enter the top results
+    int threshold = 0;
+    while (threshold < numLists) {
+        // A page in none of the shortest numEssential lists is in at most
+        // threshold lists, so the next page is the first in one of them
+        int numEssential = numLists - threshold;
+        uint32_t position = nextPosition(query->lists, numEssential);
+        if (position == POSTING_END) {
+            break;
+        }
+
+        int count = countPosition(query->lists, numLists, position);
+        if (count <= threshold) {
+            continue;
+        }
+
+        addResult(engine, query, position, count);
+        for (int c = 1; c <= count; c++) {
+            query->atLeast[c]++;
+        }
+
+        // Pages found from now on lose to every result found so far with
+        // the same count
+        while (threshold < numLists &&
+               query->atLeast[threshold + 1] >= MAX_RESULTS) {
+            threshold++;
+        }
+    }
+
+    return selectTopResults(query->results, query->numResults, MAX_RESULTS);
+}
+
+// Maps the binary index file
+// Returns NULL if there is none, if it has no PageRank values, or if
+// invertedIndex.txt or pagerankList.txt is not the file it was written with
+// (see indexFile.h)
+// With ownRanks set, the PageRank values come from elsewhere, so only
+// invertedIndex.txt matters
+static struct IndexFile *openBinaryIndex(int ownRanks) {
+    struct IndexFile *index = indexFileOpen(INDEX_FILE_NAME);
+    if (index == NULL) {
+        return NULL;
+    }
+
+    const struct IndexHeader *header = index->header;
+    if (indexSourceChanged("invertedIndex.txt", &header->textIndex) ||
+        (!ownRanks && (!(header->flags & INDEX_HAS_RANKS) ||
+         indexSourceChanged(RANK_LIST_FILE_NAME, &header->rankList)))) {
+        indexFileClose(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+// Opens and reads the pagerankList file
+// Stores the URLs in the URL table, and returns their PageRank values
+// indexed by the ID of the URL
+static double *readPagerankList(
+    const char *filename, struct InternTable *urls
+) {
+    // Opens the "pagerankList.txt" file in read mode
+    struct RankListReader reader;
+    if (!rankListOpen(&reader, filename)) {
+        fprintf(stderr, "Error opening %s", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    int capacity = 64;
+    double *pageranks = reallocOrExit(NULL, capacity * sizeof(double));
+
+    // Scans the txt file to store all the pagerank values regarding the URLs
+    const char *url;
+    int outdegree;
+    double pagerank;
+    while (rankListNext(&reader, &url, &outdegree, &pagerank)) {
+        int id = internTableInsert(urls, url);
+        if (id == capacity) {
+            capacity *= 2;
+            pageranks = reallocOrExit(pageranks, capacity * sizeof(double));
+        }
+
+        pageranks[id] = pagerank;
+    }
+
+    rankListClose(&reader);
+
+    return pageranks;
+}
+
+// Reads the exact PageRank values from a binary rank file
+// Stores the URLs in the URL table, and returns their PageRank values
+// indexed by the ID of the URL
+static double *readRankFile(const char *filename, struct InternTable *urls) {
+    struct RankFile *ranks = rankFileOpen(filename);
+    if (ranks == NULL) {
+        fprintf(stderr, "Error opening %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    double *pageranks = reallocOrExit(NULL,
+        (ranks->numPages + 1) * sizeof(double));
+    for (int i = 0; i < ranks->numPages; i++) {
+        int id = internTableInsert(urls, rankFileUrl(ranks, i));
+        pageranks[id] = ranks->pageranks[i];
+    }
+
+    rankFileClose(ranks);
+
+    return pageranks;
+}
+
+// Reads the exact PageRank values from a binary rank file for the pages of
+// the binary index, which numbers them differently
+// Pages missing from the rank file get a PageRank value of 0
+static double *matchRanks(const char *filename, struct IndexFile *index) {
+    struct InternTable *urls = internTableNew();
+    double *rankOf = readRankFile(filename, urls);
+
+    double *pageranks = reallocOrExit(NULL,
+        (index->numPages + 1) * sizeof(double));
+    for (int i = 0; i < index->numPages; i++) {
+        int id = internTableFind(urls, indexFileUrl(index, i));
+        pageranks[i] = id != NOT_FOUND ? rankOf[id] : 0;
+    }
+
+    free(rankOf);
+    internTableFree(urls);
+
+    return pageranks;
+}
+
+// Opens and reads the invertedIndex file
+// Each line holds a word followed by the URLs it appears in. The words are
+// stored in a table of their own, and the offsets of their posting lists in
+// engine->postingOffsets. URLs missing from pagerankList.txt are left out.
+// Returns the posting lists, holding the IDs of the URLs
+static uint32_t *readInvertedIndex(
+    char *filename, struct SearchEngine *engine
+) {
+    // Opens the "invertedIndex.txt" file in read mode
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error opening %s", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    engine->terms = internTableNew();
+
+    size_t offsetCapacity = 64;
+    size_t postingCapacity = 64;
+    engine->postingOffsets = reallocOrExit(NULL,
+        offsetCapacity * sizeof(uint64_t));
+    uint32_t *postings = reallocOrExit(NULL,
+        postingCapacity * sizeof(uint32_t));
+    engine->postingOffsets[0] = 0;
+
+    uint64_t numPostings = 0;
+    char *line = NULL;
+    size_t lineSize = 0;
+    ssize_t length;
+    while ((length = getline(&line, &lineSize, file)) != -1) {
+        statsAdd(STATS_BYTES_READ, length);
+        char *save = NULL;
+        char *word = strtok_r(line, " \t\r\n", &save);
+        if (word == NULL) {
+            continue;
+        }
+
+        // The same word on a second line would have the same ID
+        int numTerms = internTableSize(engine->terms);
+        if (internTableInsert(engine->terms, word) != numTerms) {
+            continue;
+        }
+
+        char *url;
+        while ((url = strtok_r(NULL, " \t\r\n", &save)) != NULL) {
+            int page = internTableFind(engine->urls, url);
+            if (page == NOT_FOUND) {
+                continue;
+            }
+
+            if (numPostings == postingCapacity) {
+                postingCapacity *= 2;
+                postings = reallocOrExit(postings,
+                    postingCapacity * sizeof(uint32_t));
+            }
+            postings[numPostings++] = page;
+        }
+
+        if ((size_t)numTerms + 2 > offsetCapacity) {
+            offsetCapacity *= 2;
+            engine->postingOffsets = reallocOrExit(engine->postingOffsets,
+                offsetCapacity * sizeof(uint64_t));
+        }
+        engine->postingOffsets[numTerms + 1] = numPostings;
+    }
+
+    free(line);
+    fclose(file);
+
+    return postings;
+}
+
+// Numbers the pages in impact order, and compresses every posting list as
+// the positions of its pages in that order, from the best page down
+// postings holds the page IDs of every list, at engine->postings'
+// postingOffsets
+static void buildImpactOrder(
+    struct SearchEngine *engine, const uint32_t *postings
+) {
+    int numPages = engine->numPages;
+    struct SearchIndex *order = reallocOrExit(NULL,
+        (numPages + 1) * sizeof(struct SearchIndex));
+    for (int i = 0; i < numPages; i++) {
+        order[i].page = i;
+        order[i].count = 0;
+        order[i].pagerank = engine->pageranks[i];
+        order[i].url = pageUrl(engine, i);
+    }
+
+    qsort(order, numPages, sizeof(struct SearchIndex), compareImpact);
+
+    uint32_t *positionOf = reallocOrExit(NULL,
+        (numPages + 1) * sizeof(uint32_t));
+    engine->pageAt = reallocOrExit(NULL, (numPages + 1) * sizeof(uint32_t));
+    for (int i = 0; i < numPages; i++) {
+        engine->pageAt[i] = order[i].page;
+        positionOf[order[i].page] = i;
+    }
+
+    int numTerms = engine->postings.numTerms;
+    const uint64_t *offsets = engine->postings.postingOffsets;
+    uint32_t *positions = reallocOrExit(NULL,
+        (offsets[numTerms] + 1) * sizeof(uint32_t));
+    for (uint64_t k = 0; k < offsets[numTerms]; k++) {
+        positions[k] = positionOf[postings[k]];
+    }
+
+    for (int t = 0; t < numTerms; t++) {
+        qsort(positions + offsets[t], offsets[t + 1] - offsets[t],
+            sizeof(uint32_t), compareIds);
+    }
+
+    postingsEncode(numTerms, offsets, positions, &engine->encoded);
+    engine->postings.blockOffsets = engine->encoded.blockOffsets;
+    engine->postings.blocks = engine->encoded.blocks;
+    engine->postings.bytes = engine->encoded.bytes;
+
+    free(order);
+    free(positionOf);
+    free(positions);
+}
+
+// Sets the counters of the pages, words and postings of the index, for
+// --stats
+static void countIndex(struct SearchEngine *engine) {
+    int numTerms = engine->postings.numTerms;
+    statsSet(STATS_PAGES, engine->numPages);
+    statsSet(STATS_TERMS, numTerms);
+    statsSet(STATS_POSTINGS, engine->postings.postingOffsets[numTerms]);
+}
+
+// Compares two pages, with a count of 0, for qsort in impact order
+static int compareImpact(const void *a, const void *b) {
+    return compareResults((struct SearchIndex *)a, (struct SearchIndex *)b);
+}
+
+// Compares two page IDs or positions for qsort
+static int compareIds(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Finds the posting list of every search term, ignoring terms no page
+// contains and terms given more than once
+// Stores the lists in query->lists, shortest first
+// Returns the number of lists
+static int findPostingLists(
+    struct SearchEngine *engine, struct SearchQuery *query, int numTerms,
+    char **terms
+) {
+    if (numTerms > query->listCapacity) {
+        query->listCapacity = numTerms;
+        query->lists = reallocOrExit(query->lists,
+            numTerms * sizeof(struct PostingCursor));
+        query->atLeast = reallocOrExit(query->atLeast,
+            (numTerms + 1) * sizeof(int));
+    }
+
+    const uint64_t *offsets = engine->postings.postingOffsets;
+
+    int numLists = 0;
+    for (int i = 0; i < numTerms; i++) {
+        int repeated = 0;
+        for (int j = 0; j < i; j++) {
+            if (strcmp(terms[i], terms[j]) == 0) {
+                repeated = 1;
+            }
+        }
+
+        int term = findTerm(engine, terms[i]);
+        if (repeated || term == NOT_FOUND) {
+            continue;
+        }
+
+        // Inserts the list in order of length
+        uint64_t length = offsets[term + 1] - offsets[term];
+        int pos = numLists++;
+        while (pos > 0 && query->lists[pos - 1].length > length) {
+            query->lists[pos] = query->lists[pos - 1];
+            pos--;
+        }
+        postingCursorOpen(&query->lists[pos], &engine->postings, term);
+    }
+
+    return numLists;
+}
+
+// Returns the smallest position at the cursors of the lists, or
+// POSTING_END if they have all been used up
+static uint32_t nextPosition(struct PostingCursor *lists, int numLists) {
+    uint32_t position = POSTING_END;
+    for (int l = 0; l < numLists; l++) {
+        uint32_t head = postingCursorPage(&lists[l]);
+        if (head < position) {
+            position = head;
+        }
+    }
+
+    return position;
+}
+
+// Counts the lists holding the position, and moves every list past it
+static int countPosition(
+    struct PostingCursor *lists, int numLists, uint32_t position
+) {
+    int count = 0;
+    for (int l = 0; l < numLists; l++) {
+        if (postingCursorSeek(&lists[l], position) == position) {
+            postingCursorNext(&lists[l]);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// Returns the number of the word, or NOT_FOUND if no page contains it
+static int findTerm(struct SearchEngine *engine, const char *term) {
+    if (engine->index != NULL) {
+        return indexFileFindTerm(engine->index, term);
+    }
+
+    return internTableFind(engine->terms, term);
+}
+
+// Returns the URL of a page
+static const char *pageUrl(struct SearchEngine *engine, int page) {
+    if (engine->index != NULL) {
+        return indexFileUrl(engine->index, page);
+    }
+
+    return internTableString(engine->urls, page);
+}
+
+// Stores the page at a position in impact order in the results, with its
+// count and PageRank value
+static void addResult(
+    struct SearchEngine *engine, struct SearchQuery *query,
+    uint32_t position, int count
+) {
+    int page = engine->pageAt != NULL ? engine->pageAt[position] : position;
+    struct SearchIndex *result = &query->results[query->numResults++];
+    result->page = page;
+    result->count = count;
+    result->pagerank = engine->pageranks[page];
+    result->url = pageUrl(engine, page);
+}
+
+// Selects the best k results and moves them, sorted, to the front of results
+// Keeps a min-heap of the best k results seen so far, whose root is the
+// worst of them, so each other result costs at most O(log k)
+// Returns the number of results selected
+static int selectTopResults(
+    struct SearchIndex *results, int numResults, int k
+) {
+    if (k > numResults) {
+        k = numResults;
+    }
+
+    // The first k results form the heap
+    for (int i = k / 2 - 1; i >= 0; i--) {
+        siftDown(results, k, i);
+    }
+
+    // A result better than the worst in the heap replaces it
+    for (int i = k; i < numResults; i++) {
+        if (compareResults(&results[i], &results[0]) < 0) {
+            results[0] = results[i];
+            siftDown(results, k, 0);
+        }
+    }
+
+    // Heap sort: repeatedly moves the worst remaining result to the back
+    for (int size = k - 1; size > 0; size--) {
+        struct SearchIndex temp = results[0];
+        results[0] = results[size];
+        results[size] = temp;
+        siftDown(results, size, 0);
+    }
+
+    return k;
+}
+
+// Moves the result at position i down the heap until both of its children
+// are better than it
+static void siftDown(struct SearchIndex *heap, int size, int i) {
+    while (2 * i + 1 < size) {
+        int child = 2 * i + 1;
+        if (child + 1 < size &&
+            compareResults(&heap[child + 1], &heap[child]) > 0) {
+            child++;
+        }
+
+        if (compareResults(&heap[child], &heap[i]) <= 0) {
+            break;
+        }
+
+        struct SearchIndex temp = heap[i];
+        heap[i] = heap[child];
+        heap[child] = temp;
+        i = child;
+    }
+}
+
+// Compares two results in the order in which they are displayed
+// Descending order of count, then of PageRank value, then alphabetical by URL
+// Returns a negative number if result a comes first, a positive number
+// if result b comes first
+static int compareResults(struct SearchIndex *a, struct SearchIndex *b) {
+    if (a->count != b->count) {
+        return a->count > b->count ? -1 : 1;
+    }
+
+    if (a->pagerank != b->pagerank) {
+        return a->pagerank > b->pagerank ? -1 : 1;
+    }
+
+    return strcmp(a->url, b->url);
+}
+
+// Reallocates memory and exits if there is none left
+static void *reallocOrExit(void *ptr, size_t size) {
+    ptr = realloc(ptr, size);
+    if (ptr == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
@@ -0,0 +1,79 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Search Engine
+//
+// Description:
+// Loads the inverted index and the PageRank values once, then answers any
+// number of queries. The index is the binary index written by invertedIndex
+// (see indexFile.h) when invertedIndex.txt and pagerankList.txt are still
+// the files it was written with, or otherwise those text files read into
+// memory. Both give every page an ID and every word a posting list of page
+// IDs. The PageRank values may instead be read from a binary rank file
+// written by pagerank (see rankFile.h), which keeps them exactly.
+//
+// A loaded engine is never modified, so several threads can answer queries
+// at the same time, as long as each thread has its own SearchQuery.
+
+#ifndef SEARCH_ENGINE_H
+#define SEARCH_ENGINE_H
+
+#include <stdint.h>
+
+#include "internTable.h"
+#include "indexFile.h"
+#include "postingCodec.h"
+
+#define MAX_RESULTS 30
+
+struct SearchEngine {
+    int numPages;
+    const double *pageranks;
+
+    // The mapped binary index, or NULL if the text files were read
+    struct IndexFile *index;
+
+    // The text files, read into memory. The posting list of word t starts
+    // at postingOffsets[t] and ends before postingOffsets[t + 1]
+    struct InternTable *urls;
+    struct InternTable *terms;
+    double *textPageranks;
+    uint64_t *postingOffsets;
+
+    // The compressed posting lists of every word, holding positions in
+    // impact order: by PageRank value, then alphabetically by URL, the order
+    // of results with the same count. They are those of the binary index
+    // when it numbers its pages in impact order already. Otherwise pageAt[i]
+    // is the page at position i, and the lists are compressed in memory.
+    struct PostingLists postings;
+    uint32_t *pageAt;
+    struct EncodedPostings encoded;
+};
+
+// The url points into the URL table or the binary index
+struct SearchIndex {
+    int page;
+    int count;
+    double pagerank;
+    const char *url;
+};
+
+// Working space for answering one query at a time
+// lists holds the posting lists of the search terms, and atLeast[c] the
+// number of results so far with a count of at least c
+struct SearchQuery {
+    struct SearchIndex *results;
+    int numResults;
+
+    struct PostingCursor *lists;
+    int *atLeast;
+    int listCapacity;
+};
+
+struct SearchEngine *searchEngineLoad(const char *rankFilename);
+void searchEngineFree(struct SearchEngine *engine);
+
+struct SearchQuery *searchQueryNew(struct SearchEngine *engine);
+void searchQueryFree(struct SearchQuery *query);
+int searchEngineQuery(struct SearchEngine *engine, struct SearchQuery *query,
+    int numTerms, char **terms);
+
+#endif
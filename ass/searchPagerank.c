@@ -8,209 +8,151 @@
 //
 // Description:
 // This program implements a simple search engine. It reads pagerank information
-// and inverted index data from the specified files. It matches the words with
-// the search terms or keywords being searched. It filters the URLs in which the
-// words appear. It keeps track of the count and PageRank value of the
-// particular URLs. It sorts the URLs on the basis of count (or PageRank, if the
-// count is equal) in descending order. It only displays the top thirty results.
+// and inverted index data from the specified files, through the search engine
+// in searchEngine.h. It matches the words with the search terms or keywords
+// being searched. It filters the URLs in which the words appear. It keeps
+// track of the count and PageRank value of the particular URLs. It only
+// displays the top thirty results, in descending order of count (or PageRank,
+// if the count is equal, or alphabetically by URL if both are equal).
+//
+// Instead of search terms, it can be given one of the options:
+//     --serve                 loads the files once, then answers every line
+//                             of stdin as a query (see searchServer.h)
+//     --socket PATH           loads the files once, then answers the queries
+//                             sent to the Unix domain socket PATH, with
+//                             --threads N threads (default 4)
+//     --connect PATH TERMS    sends the search terms to the server at PATH,
+//                             and prints the same output as a search here
+// Searches and servers may first be given --ranks FILE, to order the results
+// by the exact PageRank values in the binary rank file FILE written by
+// pagerank --save-ranks, instead of those of pagerankList.txt, and --stats,
+// to print the stats of the run on stderr (see stats.h).
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
+#include "searchEngine.h"
+#include "searchServer.h"
+#include "stats.h"
+
 #define MIN_ARGUMENTS 2
-#define MAX_URL_LENGTH 1000
-#define MAX_PAGES 1000
-#define MAX_SEARCH_TERMS 1000
-#define MAX_WORD_LENGTH 1000
-#define MAX_RESULTS 30
-
-struct Pagerank {
-    char url[MAX_URL_LENGTH];
-    int outdegree;
-    double pagerank;
-};
-
-struct SearchIndex {
-    char url[MAX_URL_LENGTH];
-    int count;
-    double pagerank;
-};
+#define DEFAULT_SERVER_THREADS 4
 
 // Function Prototypes
-void readPagerankList(char *filename, struct Pagerank *pages, int *numPages);
-void readInvertedIndex(char *filename, struct SearchIndex *results, 
-    int *numResults, struct Pagerank *pages, int numPages, 
-    int argc, char **argv);
-int urlExists(struct Pagerank *pages, int numPages, char word[MAX_WORD_LENGTH]);
-void insertUrl(struct SearchIndex *results, int *numResults,  
-    struct Pagerank *pages, int numPages, char word[MAX_WORD_LENGTH]);
-void sortResults(struct SearchIndex *results, int numResults);
+void printUsage(char *program);
+int runServer(int argc, char **argv, int first, char *rankFilename);
 
 int main(int argc, char **argv) {
     if (argc < MIN_ARGUMENTS) {
-        fprintf(stderr, 
-            "Usage: %s <search term 1> <search term 2> ...\n", argv[0]);
+        printUsage(argv[0]);
         return 1;
     }
 
-    struct Pagerank pages[MAX_PAGES];
-    int numPages = 0;
-
-    // Opens and scans the txt file to store the PageRank values
-    // Also keeps track of the number of URLs
-    readPagerankList("pagerankList.txt", pages, &numPages);
-
-    struct SearchIndex results[MAX_SEARCH_TERMS];
-    int numResults = 0;
-
-    // Opens and reads the invertedIndex file
-    // Stores the URLs and the number of URLs
-    readInvertedIndex("invertedIndex.txt", results, &numResults,
-                    pages, numPages, argc, argv);
-
-    // Sorts the rsulting URLs on the basis of count
-    // or PageRank value if count is equal
-    sortResults(results, numResults);
+    if (strcmp(argv[1], "--connect") == 0) {
+        if (argc < 3) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return querySocket(argv[2], argc - 3, argv + 3, stdout);
+    }
 
-    int limit = 0;
-    if (numResults >= MAX_RESULTS) {
-        limit = MAX_RESULTS;
-    } else {
-        limit = numResults;
+    // Reads the options given before the search terms: the rank file, and
+    // --stats
+    char *rankFilename = NULL;
+    int first = 1;
+    while (first < argc) {
+        if (strcmp(argv[first], "--ranks") == 0 && first + 1 < argc) {
+            rankFilename = argv[first + 1];
+            first += 2;
+        } else if (strcmp(argv[first], "--stats") == 0) {
+            statsEnable();
+            first++;
+        } else {
+            break;
+        }
     }
 
-    // Displays the top 30 results
-    for (int i = 0; i < limit; i++) {
-        printf("%s\n", results[i].url);
+    if (first == argc) {
+        printUsage(argv[0]);
+        return 1;
     }
 
-    return 0;
-}
+    // Times loading and querying, if ENGINE_STATS is set or --stats is given
+    statsStart("searchPagerank");
 
-// Opens and reads the pagerankList file
-// Stores the URLs, their outdegrees and their PageRank values
-// Also keeps track of the number of URLs
-void readPagerankList(char *filename, struct Pagerank *pages, int *numPages) {
-    // Opens the "pagerankList.txt" file in read mode
-    FILE *file = fopen(filename, "r");
-    if (file == NULL) {
-        fprintf(stderr, "Error opening %s", filename);
-        exit(EXIT_FAILURE);
+    if (strncmp(argv[first], "--", 2) == 0) {
+        return runServer(argc, argv, first, rankFilename);
     }
 
-    // Scans the txt file to store all the pagerank values regarding the URLs
-    *numPages = 0;
-    while (fscanf(file, "%999[^,], %d, %lf\n", pages[*numPages].url, 
-        &pages[*numPages].outdegree, &pages[*numPages].pagerank) == 3) {
-        (*numPages)++;
+    // Loads the binary index written by invertedIndex, if it is up to date
+    // Otherwise reads the text files
+    statsPhase("load");
+    struct SearchEngine *engine = searchEngineLoad(rankFilename);
+    struct SearchQuery *query = searchQueryNew(engine);
+
+    // Displays the top 30 results
+    statsPhase("query");
+    int numResults = searchEngineQuery(engine, query, argc - first, 
+        argv + first);
+    for (int i = 0; i < numResults; i++) {
+        printf("%s\n", query->results[i].url);
     }
 
-    fclose(file);
-}
+    searchQueryFree(query);
+    searchEngineFree(engine);
 
-// Scans through the whole txt file
-// Stores all the URLs of the respective words which match the search term
-void readInvertedIndex(
-    char *filename, struct SearchIndex *results, int *numResults, 
-    struct Pagerank *pages, int numPages, int argc, char **argv
-) {
-    // Opens the "invertedIndex.txt" file in read mode
-    FILE *file = fopen(filename, "r");
-    if (file == NULL) {
-        fprintf(stderr, "Error opening %s", filename);
-        exit(EXIT_FAILURE);
-    }
+    statsFinish();
 
-    int found = 0;
-    char word[MAX_WORD_LENGTH];
-
-    // Keeps track of the number of results to be printed as output
-    // Iteratively scans all the words and their respective URLs
-    // If the word matches the search term, it stores the URL it appears in
-    *numResults = 0;
-    while (fscanf(file, "%s", word) == 1) {
-        // Checks if the word is a valid URL name and is stored or not
-        if (!urlExists(pages, numPages, word)) {
-            found = 0;
-        }
+    return 0;
+}
 
-        if (found == 1) {
-            // Inserts the URL to results array
-            insertUrl(results, numResults, pages, numPages, word);
-        }
-        
-        for (int i = 0; i < argc - 1 && (!strstr(word, "url")); i++) {
-            if (strcmp(word, argv[i + 1]) == 0) {
-                found = 1;
-            }
-        }
-    }
-    
-    fclose(file);
+// Prints how to use the program to stderr
+void printUsage(char *program) {
+    fprintf(stderr,
+        "Usage: %s [--ranks FILE] [--stats] <search term 1> <search term 2> "
+        "...\n"
+        "       %s [--ranks FILE] [--stats] --serve\n"
+        "       %s [--ranks FILE] [--stats] --socket <path> [--threads N]\n"
+        "       %s --connect <path> <search term 1> ...\n",
+        program, program, program, program);
 }
 
-// Checks if the URL is valid and exists in the stored pages array
-int urlExists(
-    struct Pagerank *pages, int numPages, char word[MAX_WORD_LENGTH]
-) {
-    for (int i = 0; i < numPages; i++) {
-        if (strcmp(word, pages[i].url) == 0) {
+// Reads the server options, loads the files once, then answers queries
+// until stdin ends (or, for a socket, until the server is stopped)
+// The options start at argv[first]
+int runServer(int argc, char **argv, int first, char *rankFilename) {
+    int serve = 0;
+    char *socketPath = NULL;
+    int numThreads = DEFAULT_SERVER_THREADS;
+    for (int i = first; i < argc; i++) {
+        if (strcmp(argv[i], "--serve") == 0) {
+            serve = 1;
+        } else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
             return 1;
         }
     }
-    return 0;
-}
 
-// Stores the URL in the results array
-// Keep count of the times the URL has appeared
-// Also stores the particular URL's PageRank value
-void insertUrl(
-    struct SearchIndex *results, int *numResults, 
-    struct Pagerank *pages, int numPages, char word[MAX_WORD_LENGTH]
-) {
-    int j = 0;
-    // Checks if the URL already exists in the results
-    for (j = 0; j <= (*numResults); j++) {
-        if (strcmp(word, results[j].url) == 0) {
-            break;
-        }
+    if (serve == (socketPath != NULL) || numThreads < 1) {
+        printUsage(argv[0]);
+        return 1;
     }
 
-    // Increments the count of the URL if it already exists
-    if (j <= (*numResults)) {
-        results[j].count++;
-    } 
-    // Stores the URL in the results if it doesn't exist
-    // Sets it's count to 1 and stores the PageRank Value for the pages array
-    else {
-        strcpy(results[(*numResults)].url, word);
-        results[(*numResults)].count = 1;
-
-        for (int k = 0; k < numPages; k++) {
-            if (strcmp(results[(*numResults)].url, pages[k].url) == 0) {
-                results[(*numResults)].pagerank = pages[k].pagerank;
-            }
-        }
-
-        (*numResults)++;
+    statsPhase("load");
+    struct SearchEngine *engine = searchEngineLoad(rankFilename);
+    statsPhase("query");
+    if (serve) {
+        serveStream(engine, stdin, stdout);
+    } else {
+        serveSocket(engine, socketPath, numThreads);
     }
-}
+    searchEngineFree(engine);
+    statsFinish();
 
-// Sorts the resulting URLs using bubble sort
-// Sorts in descending order on the basis of their count
-// If the number of times the URLs appear is same,
-// they are sorted on the basis of their PageRank values
-void sortResults(struct SearchIndex *results, int numResults) {
-    for (int i = 0; i < numResults - 1; i++) {
-        for (int j = 0; j < numResults - i - 1; j++) {
-            if (results[j].count < results[j + 1].count || 
-                (results[j].count == results[j + 1].count && 
-                results[j].pagerank < results[j + 1].pagerank)) {
-                struct SearchIndex temp = results[j];
-                results[j] = results[j + 1];
-                results[j + 1] = temp;
-            }
-        }
-    }
-}
\ No newline at end of file
+    return serve ? 0 : 1;
+}
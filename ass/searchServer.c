@@ -0,0 +1,277 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Search Server
+//
+// Description:
+// Implements the search server declared in searchServer.h. Every thread of
+// the pool waits in accept on the same listening socket, so the kernel hands
+// each new connection to one idle thread. Each thread has its own
+// SearchQuery, and the engine itself is only read.
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "searchServer.h"
+
+#define SOCKET_BACKLOG 64
+
+// Bounds of the wait after accept fails for lack of files or memory
+#define ACCEPT_MIN_DELAY_MS 10
+#define ACCEPT_MAX_DELAY_MS 1000
+
+struct ServerWorker {
+    struct SearchEngine *engine;
+    int listener;
+};
+
+static void serveLines(struct SearchEngine *engine, struct SearchQuery *query,
+    FILE *in, FILE *out);
+static void *runWorker(void *arg);
+static int socketAddress(const char *path, struct sockaddr_un *address);
+static int openConnection(int fd, FILE **in, FILE **out);
+
+// Answers the queries read from in, one line at a time, until the end of in
+void serveStream(struct SearchEngine *engine, FILE *in, FILE *out) {
+    struct SearchQuery *query = searchQueryNew(engine);
+    serveLines(engine, query, in, out);
+    searchQueryFree(query);
+}
+
+// Listens on a Unix domain socket at path and answers the queries of every
+// connection with a pool of numThreads threads
+// Only returns if the socket cannot be set up, or once every thread has
+// stopped because the socket can no longer accept connections
+void serveSocket(
+    struct SearchEngine *engine, const char *path, int numThreads
+) {
+    struct sockaddr_un address;
+    if (!socketAddress(path, &address)) {
+        fprintf(stderr, "error: socket path too long: %s\n", path);
+        return;
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        return;
+    }
+
+    // Replaces the socket left behind by a previous server
+    unlink(path);
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(listener, SOCKET_BACKLOG) != 0) {
+        perror(path);
+        close(listener);
+        return;
+    }
+
+    // A client that goes away before reading its answer must not stop the
+    // server
+    signal(SIGPIPE, SIG_IGN);
+
+    struct ServerWorker worker = {engine, listener};
+    pthread_t *threads = malloc(numThreads * sizeof(pthread_t));
+    if (threads == NULL) {
+        fprintf(stderr, "error: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int t = 0; t < numThreads; t++) {
+        if (pthread_create(&threads[t], NULL, runWorker, &worker)) {
+            fprintf(stderr, "error: cannot create thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    free(threads);
+    close(listener);
+}
+
+// Sends one query to the server listening at path, and copies its answer,
+// without the empty line ending it, to out
+// Returns 0 on success, or 1 if the server could not be reached
+int querySocket(const char *path, int numTerms, char **terms, FILE *out) {
+    struct sockaddr_un address;
+    if (!socketAddress(path, &address)) {
+        fprintf(stderr, "error: socket path too long: %s\n", path);
+        return 1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 ||
+        connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        perror(path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 1;
+    }
+
+    FILE *in;
+    FILE *conn;
+    if (!openConnection(fd, &in, &conn)) {
+        perror(path);
+        return 1;
+    }
+
+    for (int i = 0; i < numTerms; i++) {
+        fprintf(conn, i == 0 ? "%s" : " %s", terms[i]);
+    }
+    fprintf(conn, "\n");
+    fclose(conn);
+
+    char *line = NULL;
+    size_t lineSize = 0;
+    while (getline(&line, &lineSize, in) != -1 && strcmp(line, "\n") != 0) {
+        fputs(line, out);
+    }
+
+    free(line);
+    fclose(in);
+    return 0;
+}
+
+// Answers every line of in as a query, writing the answers to out
+static void serveLines(
+    struct SearchEngine *engine, struct SearchQuery *query,
+    FILE *in, FILE *out
+) {
+    char *line = NULL;
+    size_t lineSize = 0;
+    char **terms = NULL;
+    ssize_t length;
+    while ((length = getline(&line, &lineSize, in)) != -1) {
+        // A line of n characters holds at most n / 2 + 1 terms
+        terms = realloc(terms, (length / 2 + 1) * sizeof(char *));
+        if (terms == NULL) {
+            fprintf(stderr, "error: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+
+        int numTerms = 0;
+        char *save = NULL;
+        char *term = strtok_r(line, " \t\r\n", &save);
+        while (term != NULL) {
+            terms[numTerms++] = term;
+            term = strtok_r(NULL, " \t\r\n", &save);
+        }
+
+        // A blank line is not searched, and is answered with the empty line
+        // alone, so a client waiting for the end of the answer gets it
+        int numResults = 0;
+        if (numTerms > 0) {
+            numResults = searchEngineQuery(engine, query, numTerms, terms);
+        }
+        for (int i = 0; i < numResults; i++) {
+            fprintf(out, "%s\n", query->results[i].url);
+        }
+        fprintf(out, "\n");
+
+        if (fflush(out) != 0) {
+            break;
+        }
+    }
+
+    free(terms);
+    free(line);
+}
+
+// Accepts connections and answers their queries, one connection at a time
+// Stops if accept fails for any reason other than an interruption, a client
+// giving up, or running out of files or memory
+static void *runWorker(void *arg) {
+    struct ServerWorker *worker = arg;
+    struct SearchQuery *query = searchQueryNew(worker->engine);
+
+    int delay = 0;
+    while (1) {
+        int fd = accept(worker->listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            // Running out of files or memory lasts until other connections
+            // close, so the thread waits longer after each failure instead
+            // of spinning, and reports the error once
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS ||
+                errno == ENOMEM) {
+                if (delay == 0) {
+                    perror("accept");
+                    delay = ACCEPT_MIN_DELAY_MS;
+                } else if (delay < ACCEPT_MAX_DELAY_MS) {
+                    delay *= 2;
+                }
+                usleep(delay * 1000);
+                continue;
+            }
+
+            // Any other error means the listening socket itself is broken
+            perror("accept");
+            break;
+        }
+        delay = 0;
+
+        FILE *in;
+        FILE *out;
+        if (!openConnection(fd, &in, &out)) {
+            continue;
+        }
+
+        serveLines(worker->engine, query, in, out);
+        fclose(in);
+        fclose(out);
+    }
+
+    searchQueryFree(query);
+    return NULL;
+}
+
+// Fills in the address of the socket at path
+// Returns 0 if the path is too long for a socket address
+static int socketAddress(const char *path, struct sockaddr_un *address) {
+    if (strlen(path) >= sizeof(address->sun_path)) {
+        return 0;
+    }
+
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, path);
+    return 1;
+}
+
+// Opens separate streams for reading from and writing to a connection, since
+// one stream cannot switch between reading and writing on a socket
+// Closes the connection and returns 0 if the streams cannot be opened
+static int openConnection(int fd, FILE **in, FILE **out) {
+    int outFd = dup(fd);
+    *in = fdopen(fd, "r");
+    *out = outFd >= 0 ? fdopen(outFd, "w") : NULL;
+    if (*in == NULL || *out == NULL) {
+        if (*in != NULL) {
+            fclose(*in);
+        } else {
+            close(fd);
+        }
+        if (*out != NULL) {
+            fclose(*out);
+        } else if (outFd >= 0) {
+            close(outFd);
+        }
+        return 0;
+    }
+
+    return 1;
+}
@@ -0,0 +1,29 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Search Server
+//
+// Description:
+// Answers queries on a loaded search engine (see searchEngine.h) for as long
+// as they keep coming, so the index is only loaded once. Each query is one
+// line of search terms separated by spaces. The answer is the same list of
+// URLs that searchPagerank would print for those terms, one per line,
+// followed by an empty line. A line without any terms is not searched, and
+// its answer is the empty line alone.
+//
+// Queries are read either from a stream (such as stdin), one after another,
+// or from the connections to a Unix domain socket. Each connection may send
+// any number of queries, and is served by one thread of a fixed pool, so
+// several connections are served at the same time.
+
+#ifndef SEARCH_SERVER_H
+#define SEARCH_SERVER_H
+
+#include <stdio.h>
+
+#include "searchEngine.h"
+
+void serveStream(struct SearchEngine *engine, FILE *in, FILE *out);
+void serveSocket(struct SearchEngine *engine, const char *path,
+    int numThreads);
+int querySocket(const char *path, int numTerms, char **terms, FILE *out);
+
+#endif
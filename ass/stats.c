@@ -0,0 +1,309 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Stats
+//
+// Description:
+// Implements the stats declared in stats.h. The times are read with
+// clock_gettime, the CPU time being that of the whole process, so it counts
+// every thread. The peak resident memory is read with getrusage. The
+// counters are added to atomically, since the readers of invertedIndex and
+// the server threads of searchPagerank count at the same time.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "stats.h"
+
+#define MAX_PHASES 32
+#define INITIAL_ITERATIONS 64
+
+struct Phase {
+    const char *name;
+    double wall;
+    double cpu;
+};
+
+struct Iteration {
+    const char *solver;
+    int iteration;
+    double diff;
+    double elapsed;
+    long long edges;
+};
+
+// The stats of the program, kept for the whole run
+struct Stats {
+    int enabled;
+    const char *program;
+    double startWall;
+    double startCpu;
+
+    struct Phase phases[MAX_PHASES];
+    int numPhases;
+    int current;
+    double phaseWall;
+    double phaseCpu;
+
+    // The time the last iteration ended, or its phase started
+    double iterationWall;
+    struct Iteration *iterations;
+    int numIterations;
+    int iterationCapacity;
+
+    long long counters[NUM_STATS_COUNTERS];
+    int counterSet[NUM_STATS_COUNTERS];
+};
+
+static struct Stats stats;
+
+static const char *counterNames[NUM_STATS_COUNTERS] = {
+    [STATS_PAGES] = "pages",
+    [STATS_EDGES] = "edges",
+    [STATS_DANGLING_PAGES] = "danglingPages",
+    [STATS_TERMS] = "terms",
+    [STATS_POSTINGS] = "postings",
+    [STATS_QUERIES] = "queries",
+    [STATS_BYTES_READ] = "bytesRead",
+    [STATS_ALLOCATIONS] = "allocations",
+    [STATS_ALLOCATED_BYTES] = "allocatedBytes",
+    [STATS_CUT_EDGES] = "cutEdges",
+};
+
+#ifdef STATS_COUNT_ALLOCATIONS
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t count, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+#endif
+
+static void endPhase(void);
+static void printIterations(void);
+static void printCounters(void);
+#ifdef STATS_COUNT_ALLOCATIONS
+static void countAllocation(size_t size);
+#endif
+static double readClock(clockid_t clock);
+
+// Turns the stats on, as --stats does
+// Must be called before statsStart
+void statsEnable(void) {
+    stats.enabled = 1;
+}
+
+// Returns whether the stats are being recorded
+int statsEnabled(void) {
+    return stats.enabled;
+}
+
+// Starts timing the program, if ENGINE_STATS is set or statsEnable was
+// called
+void statsStart(const char *program) {
+    stats.enabled = stats.enabled || getenv(STATS_ENV_NAME) != NULL;
+    stats.program = program;
+    stats.numPhases = 0;
+    stats.current = -1;
+    stats.startWall = readClock(CLOCK_MONOTONIC);
+    stats.startCpu = readClock(CLOCK_PROCESS_CPUTIME_ID);
+    stats.iterationWall = stats.startWall;
+}
+
+// Ends the current phase, and starts the phase with the given name
+void statsPhase(const char *name) {
+    if (!stats.enabled) {
+        return;
+    }
+
+    endPhase();
+
+    int i = 0;
+    while (i < stats.numPhases && strcmp(stats.phases[i].name, name) != 0) {
+        i++;
+    }
+
+    // Phases past the last slot are not recorded
+    if (i == MAX_PHASES) {
+        return;
+    }
+
+    if (i == stats.numPhases) {
+        stats.phases[i].name = name;
+        stats.phases[i].wall = 0;
+        stats.phases[i].cpu = 0;
+        stats.numPhases++;
+    }
+
+    stats.current = i;
+    stats.phaseWall = readClock(CLOCK_MONOTONIC);
+    stats.phaseCpu = readClock(CLOCK_PROCESS_CPUTIME_ID);
+    stats.iterationWall = stats.phaseWall;
+}
+
+// Sets a counter to a value
+void statsSet(enum StatsCounter counter, long long value) {
+    if (!stats.enabled) {
+        return;
+    }
+
+    __atomic_store_n(&stats.counters[counter], value, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats.counterSet[counter], 1, __ATOMIC_RELAXED);
+}
+
+// Adds a value to a counter
+// May be called by several threads at once
+void statsAdd(enum StatsCounter counter, long long value) {
+    if (!stats.enabled) {
+        return;
+    }
+
+    __atomic_fetch_add(&stats.counters[counter], value, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats.counterSet[counter], 1, __ATOMIC_RELAXED);
+}
+
+// Records the end of an iteration of a solver: the difference it ended
+// with and the number of edges it went over
+// Its time is that since the last iteration ended, or since the current
+// phase started
+void statsIteration(
+    const char *solver, int iteration, double diff, long long edges
+) {
+    if (!stats.enabled) {
+        return;
+    }
+
+    if (stats.numIterations == stats.iterationCapacity) {
+        int capacity = stats.iterationCapacity == 0 ? INITIAL_ITERATIONS :
+            stats.iterationCapacity * 2;
+        struct Iteration *iterations = realloc(stats.iterations,
+            capacity * sizeof(struct Iteration));
+        if (iterations == NULL) {
+            fprintf(stderr, "error: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        stats.iterations = iterations;
+        stats.iterationCapacity = capacity;
+    }
+
+    double now = readClock(CLOCK_MONOTONIC);
+    struct Iteration *entry = &stats.iterations[stats.numIterations++];
+    entry->solver = solver;
+    entry->iteration = iteration;
+    entry->diff = diff;
+    entry->elapsed = now - stats.iterationWall;
+    entry->edges = edges;
+    stats.iterationWall = now;
+}
+
+// Ends the current phase, and prints the stats of the program on stderr
+void statsFinish(void) {
+    if (!stats.enabled) {
+        return;
+    }
+
+    endPhase();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    fprintf(stderr, "{\"program\": \"%s\", \"wall\": %.6f, \"cpu\": %.6f, "
+        "\"maxRssKb\": %ld, \"phases\": [", stats.program,
+        readClock(CLOCK_MONOTONIC) - stats.startWall,
+        readClock(CLOCK_PROCESS_CPUTIME_ID) - stats.startCpu,
+        usage.ru_maxrss);
+    for (int i = 0; i < stats.numPhases; i++) {
+        fprintf(stderr, "%s{\"name\": \"%s\", \"wall\": %.6f, \"cpu\": %.6f}",
+            i > 0 ? ", " : "", stats.phases[i].name, stats.phases[i].wall,
+            stats.phases[i].cpu);
+    }
+    fprintf(stderr, "]");
+    printIterations();
+    printCounters();
+    fprintf(stderr, "}\n");
+
+    free(stats.iterations);
+    stats.iterations = NULL;
+    stats.numIterations = 0;
+    stats.iterationCapacity = 0;
+}
+
+#ifdef STATS_COUNT_ALLOCATIONS
+// Counts an allocation made with malloc
+void *__wrap_malloc(size_t size) {
+    countAllocation(size);
+    return __real_malloc(size);
+}
+
+// Counts an allocation made with calloc
+void *__wrap_calloc(size_t count, size_t size) {
+    countAllocation(count * size);
+    return __real_calloc(count, size);
+}
+
+// Counts an allocation made with realloc
+void *__wrap_realloc(void *ptr, size_t size) {
+    countAllocation(size);
+    return __real_realloc(ptr, size);
+}
+#endif
+
+// Adds the time since the current phase started to it
+static void endPhase(void) {
+    if (stats.current < 0) {
+        return;
+    }
+
+    struct Phase *phase = &stats.phases[stats.current];
+    phase->wall += readClock(CLOCK_MONOTONIC) - stats.phaseWall;
+    phase->cpu += readClock(CLOCK_PROCESS_CPUTIME_ID) - stats.phaseCpu;
+    stats.current = -1;
+}
+
+// Prints the iterations recorded, if there are any
+static void printIterations(void) {
+    if (stats.numIterations == 0) {
+        return;
+    }
+
+    fprintf(stderr, ", \"iterations\": [");
+    for (int i = 0; i < stats.numIterations; i++) {
+        struct Iteration *entry = &stats.iterations[i];
+        fprintf(stderr, "%s{\"solver\": \"%s\", \"iteration\": %d, "
+            "\"diff\": %.9g, \"elapsed\": %.6f, \"edges\": %lld, "
+            "\"edgesPerSec\": %.1f}", i > 0 ? ", " : "", entry->solver,
+            entry->iteration, entry->diff, entry->elapsed, entry->edges,
+            entry->elapsed > 0 ? entry->edges / entry->elapsed : 0.0);
+    }
+    fprintf(stderr, "]");
+}
+
+// Prints the counters that were set
+static void printCounters(void) {
+    fprintf(stderr, ", \"counters\": {");
+    int printed = 0;
+    for (int c = 0; c < NUM_STATS_COUNTERS; c++) {
+        if (stats.counterSet[c]) {
+            fprintf(stderr, "%s\"%s\": %lld", printed > 0 ? ", " : "",
+                counterNames[c], stats.counters[c]);
+            printed++;
+        }
+    }
+    fprintf(stderr, "}");
+}
+
+#ifdef STATS_COUNT_ALLOCATIONS
+// Counts an allocation of the given size
+static void countAllocation(size_t size) {
+    statsAdd(STATS_ALLOCATIONS, 1);
+    statsAdd(STATS_ALLOCATED_BYTES, size);
+}
+#endif
+
+// Returns the time of a clock in seconds
+static double readClock(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,57 @@
+// COMP2521 Assignment - Simple Graph Structure-Based Search Engine
+// Stats
+//
+// Description:
+// Optional stats of a program, for benchmarks (see bench/runBench) and for
+// watching production runs. When the environment variable ENGINE_STATS is
+// set, or the program is given --stats, it records the wall clock and CPU
+// time of each phase, the difference and time of every PageRank iteration,
+// and a few counters, and prints them as one JSON object on stderr when it
+// finishes, together with its total times and peak resident memory:
+//     {"program": "pagerank", "wall": 1.25, "cpu": 1.24, "maxRssKb": 5120,
+//      "phases": [{"name": "parse", "wall": 0.5, "cpu": 0.49}, ...],
+//      "iterations": [{"solver": "jacobi", "iteration": 1, "diff": 0.4,
+//                      "elapsed": 0.01, "edges": 1000,
+//                      "edgesPerSec": 100000.0}, ...],
+//      "counters": {"pages": 100, "edges": 1000, ...}}
+// A phase lasts until the next one starts. A phase entered more than once
+// is reported once, with its times added up. Only the counters a program
+// sets are reported. Otherwise the functions do nothing, so they cost
+// nothing in normal runs.
+//
+// The allocations are only counted in a build made with
+// make COUNT_ALLOCATIONS=1, which defines STATS_COUNT_ALLOCATIONS and wraps
+// malloc, calloc and realloc at link time (-Wl,--wrap, see the Makefile).
+// The counts cover the calls of the program itself, not those made inside
+// the C library. Other builds call the allocator directly.
+
+#ifndef STATS_H
+#define STATS_H
+
+#define STATS_ENV_NAME "ENGINE_STATS"
+
+enum StatsCounter {
+    STATS_PAGES,
+    STATS_EDGES,
+    STATS_DANGLING_PAGES,
+    STATS_TERMS,
+    STATS_POSTINGS,
+    STATS_QUERIES,
+    STATS_BYTES_READ,
+    STATS_ALLOCATIONS,
+    STATS_ALLOCATED_BYTES,
+    STATS_CUT_EDGES,
+    NUM_STATS_COUNTERS
+};
+
+void statsEnable(void);
+int statsEnabled(void);
+void statsStart(const char *program);
+void statsPhase(const char *name);
+void statsSet(enum StatsCounter counter, long long value);
+void statsAdd(enum StatsCounter counter, long long value);
+void statsIteration(const char *solver, int iteration, double diff,
+    long long edges);
+void statsFinish(void);
+
+#endif